@@ -0,0 +1,343 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <utility>
+
+// Doubly linked list that many threads insert into, erase from and iterate
+// at once. There is no list-wide lock: every node carries its own spinlock,
+// an insert locks only the two nodes it goes between and an erase the node
+// and its two neighbours, so writers at different positions do not wait
+// for each other.
+//
+// Iterators stay valid whatever other threads do. An iterator holds a
+// reference on its node, and an erased node is only unlinked: it is freed
+// when the last iterator leaves it. It keeps pointing at its old successor,
+// and holds a reference on it, so incrementing an iterator whose element
+// was erased continues with the elements that followed it.
+//
+// Elements cannot be changed in place, so reading through an iterator
+// needs no lock. Nodes are allocated and freed by whichever thread inserts
+// or drops the last reference, so the allocator must be thread-safe; a
+// StackAllocator is not.
+template <typename T, typename Alloc = std::allocator<T>>
+class ConcurrentList {
+  private:
+    class SpinLock {
+      private:
+        static constexpr int kSpins = 64;
+
+        std::atomic_flag flag;
+
+      public:
+        void lock() {
+            while (flag.test_and_set(std::memory_order_acquire)) {
+                for (int i = 0; flag.test(std::memory_order_relaxed); ++i) {
+                    if (i >= kSpins) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        }
+
+        bool try_lock() {
+            return !flag.test_and_set(std::memory_order_acquire);
+        }
+
+        void unlock() {
+            flag.clear(std::memory_order_release);
+        }
+    };
+
+    // Locks are taken in list order and only try_lock goes backwards, so
+    // no two threads can wait for each other. prev and next change only
+    // under the node's lock; once the node is dead they never change.
+    struct BaseNode {
+        SpinLock lock;
+        BaseNode* prev = nullptr;
+        BaseNode* next = nullptr;
+        std::atomic<size_t> refs = 1;  // 1 for being linked
+        std::atomic<bool> dead = false;
+    };
+    struct Node : BaseNode {
+        T val;
+
+        template <typename... Args>
+        Node(std::in_place_t /*unused*/, Args&&... args)
+            : val(std::forward<Args>(args)...) {}
+    };
+
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+
+    [[no_unique_address]] NodeAlloc allocator;
+    std::atomic<size_t> sz = 0;
+    // Two sentinels rather than a ring, so that list order is a total
+    // order to lock in.
+    BaseNode head;
+    BaseNode tail;
+
+    void free_node(BaseNode* node) {
+        Node* real = static_cast<Node*>(node);
+        NodeAllocTraits::destroy(allocator, real);
+        NodeAllocTraits::deallocate(allocator, real, 1);
+    }
+
+    // The sentinels are not counted: they are never freed, and every
+    // push_back would otherwise write to the tail's counter.
+    void acquire(BaseNode* node) {
+        if (node != &tail) {
+            node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Drops a reference. A node can only lose its last one after it was
+    // erased, and then its reference on the successor goes too.
+    void release(BaseNode* node) {
+        while (node != &tail &&
+               node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            BaseNode* next = node->next;
+            free_node(node);
+            node = next;
+        }
+    }
+
+    // Links node in before the first live node at or after pos. The caller
+    // keeps pos referenced, and with it every node its successor chain
+    // leads through.
+    void link_before(BaseNode* pos, BaseNode* node) {
+        while (true) {
+            if (pos->dead.load(std::memory_order_acquire)) {
+                pos = pos->next;
+                continue;
+            }
+            pos->lock.lock();
+            if (pos->dead.load(std::memory_order_relaxed)) {
+                pos->lock.unlock();
+                continue;
+            }
+            BaseNode* prev = pos->prev;
+            if (!prev->lock.try_lock()) {
+                pos->lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            node->prev = prev;
+            node->next = pos;
+            prev->next = node;
+            pos->prev = node;
+            sz.fetch_add(1, std::memory_order_relaxed);
+            prev->lock.unlock();
+            pos->lock.unlock();
+            return;
+        }
+    }
+
+  public:
+    // Forward iterator that pins its node; see the class comment.
+    class const_iterator {
+      private:
+        friend ConcurrentList;
+
+        ConcurrentList* owner = nullptr;
+        BaseNode* node = nullptr;
+
+        // Takes over a reference the caller already holds.
+        const_iterator(ConcurrentList* owner, BaseNode* node)
+            : owner(owner), node(node) {}
+
+      public:
+        using value_type = T;
+        using reference = const T&;
+        using pointer = const T*;
+        using difference_type = ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        const_iterator() = default;
+
+        const_iterator(const const_iterator& another)
+            : owner(another.owner), node(another.node) {
+            if (node != nullptr) {
+                owner->acquire(node);
+            }
+        }
+
+        const_iterator(const_iterator&& another) noexcept
+            : owner(another.owner), node(std::exchange(another.node, nullptr)) {}
+
+        const_iterator& operator=(const_iterator another) noexcept {
+            std::swap(owner, another.owner);
+            std::swap(node, another.node);
+            return *this;
+        }
+
+        ~const_iterator() {
+            if (node != nullptr) {
+                owner->release(node);
+            }
+        }
+
+        // Moves to the next element that is still in the list.
+        const_iterator& operator++() {
+            BaseNode* from = node;
+            do {
+                node->lock.lock();
+                BaseNode* next = node->next;
+                owner->acquire(next);
+                node->lock.unlock();
+                if (node != from) {
+                    owner->release(node);
+                }
+                node = next;
+            } while (node != &owner->tail &&
+                     node->dead.load(std::memory_order_acquire));
+            owner->release(from);
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return node == other.node;
+        }
+
+        reference operator*() const {
+            return static_cast<const Node*>(node)->val;
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+
+        // False once some thread has erased the element.
+        bool alive() const {
+            return !node->dead.load(std::memory_order_acquire);
+        }
+    };
+
+    ConcurrentList(const Alloc& alloc = Alloc())
+        : allocator(alloc) {
+        head.next = &tail;
+        tail.prev = &head;
+    }
+
+    ConcurrentList(const ConcurrentList&) = delete;
+    ConcurrentList& operator=(const ConcurrentList&) = delete;
+
+    // No iterator may outlive the list.
+    ~ConcurrentList() {
+        BaseNode* node = head.next;
+        while (node != &tail) {
+            BaseNode* next = node->next;
+            free_node(node);
+            node = next;
+        }
+    }
+
+    // Number of elements, exact whenever no write is in flight.
+    size_t size() const {
+        return sz.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    const_iterator begin() {
+        head.lock.lock();
+        BaseNode* first = head.next;
+        acquire(first);
+        head.lock.unlock();
+        return const_iterator(this, first);
+    }
+
+    const_iterator end() {
+        acquire(&tail);
+        return const_iterator(this, &tail);
+    }
+
+    // Inserts before pos, or before the first element after it that is
+    // still in the list if pos was erased.
+    template <typename... Args>
+    const_iterator emplace(const const_iterator& pos, Args&&... args) {
+        Node* node = NodeAllocTraits::allocate(allocator, 1);
+        try {
+            NodeAllocTraits::construct(allocator, node, std::in_place,
+                                       std::forward<Args>(args)...);
+        } catch (...) {
+            NodeAllocTraits::deallocate(allocator, node, 1);
+            throw;
+        }
+        acquire(node);
+        link_before(pos.node, node);
+        return const_iterator(this, node);
+    }
+
+    const_iterator insert(const const_iterator& pos, const T& el) {
+        return emplace(pos, el);
+    }
+
+    void push_back(const T& el) {
+        emplace(end(), el);
+    }
+
+    void push_front(const T& el) {
+        emplace(begin(), el);
+    }
+
+    // Unlinks the element at pos. Returns false if another thread already
+    // erased it.
+    bool erase(const const_iterator& pos) {
+        BaseNode* node = pos.node;
+        while (true) {
+            node->lock.lock();
+            if (node->dead.load(std::memory_order_relaxed)) {
+                node->lock.unlock();
+                return false;
+            }
+            BaseNode* prev = node->prev;
+            if (!prev->lock.try_lock()) {
+                node->lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+            BaseNode* next = node->next;
+            next->lock.lock();
+            prev->next = next;
+            next->prev = prev;
+            acquire(next);
+            node->dead.store(true, std::memory_order_release);
+            sz.fetch_sub(1, std::memory_order_relaxed);
+            next->lock.unlock();
+            prev->lock.unlock();
+            node->lock.unlock();
+            release(node);
+            return true;
+        }
+    }
+
+    // Calls f on every element with hand-over-hand locking: each node is
+    // locked before its predecessor is let go, so the scan never sees a
+    // half-made change and a writer waits only for the node being visited.
+    // f must not modify the list.
+    template <typename F>
+    void for_each(F&& f) {
+        BaseNode* node = &head;
+        node->lock.lock();
+        while (node->next != &tail) {
+            BaseNode* next = node->next;
+            next->lock.lock();
+            node->lock.unlock();
+            node = next;
+            f(static_cast<const Node*>(node)->val);
+        }
+        node->lock.unlock();
+    }
+};
@@ -0,0 +1,353 @@
+#pragma once
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "node_container.h"
+
+// Singly linked counterpart of List for containers that only ever walk
+// forward: a node carries one link instead of two, and every insert and
+// erase touches one neighbour fewer. Allocators are handled exactly as in
+// List. A tail pointer keeps push_back O(1).
+template <typename T, typename Alloc = std::allocator<T>>
+class ForwardList : private list_detail::NodeContainer<ForwardList<T, Alloc>, T, Alloc,
+                                                       list_detail::ForwardLinks> {
+  private:
+    using Base = list_detail::NodeContainer<ForwardList<T, Alloc>, T, Alloc,
+                                            list_detail::ForwardLinks>;
+    friend Base;
+
+    using typename Base::BaseNode;
+    using typename Base::Node;
+    using typename Base::NodeAllocTraits;
+    using Base::allocator;
+    using Base::construct_from;
+    using Base::destroy_node;
+    using Base::make_node;
+    using Base::steal;
+    using Base::sz;
+    using Base::unconst;
+
+    BaseNode head;            // before_begin(); head.next is the first node
+    BaseNode* tail = &head;   // last node, or &head when empty
+
+    // Links the chain [first, last] of count nodes in after prev.
+    constexpr void link_after(BaseNode* prev, BaseNode* first, BaseNode* last,
+                              size_t count) noexcept {
+        last->next = prev->next;
+        prev->next = first;
+        if (tail == prev) {
+            tail = last;
+        }
+        sz += count;
+    }
+
+    constexpr void reset() noexcept {
+        head.next = nullptr;
+        tail = &head;
+        sz = 0;
+    }
+
+    constexpr void take_links(ForwardList& another) noexcept {
+        head.next = another.head.next;
+        tail = another.tail;
+        another.head.next = nullptr;
+        another.tail = &another.head;
+    }
+
+    constexpr void truncate(size_t n) {
+        erase_after(std::next(cbefore_begin(), static_cast<ptrdiff_t>(n)), cend());
+    }
+
+    constexpr void splice_back(ForwardList& another) noexcept {
+        splice_after(const_iterator(tail), another);
+    }
+
+    // A nullptr-terminated chain of nodes, as sort() juggles them.
+    struct Chain {
+        BaseNode* first = nullptr;
+        BaseNode* last = nullptr;
+    };
+
+    // Stable merge of two sorted chains, left holding the earlier elements.
+    template <typename Compare>
+    static constexpr Chain merge(Chain left, Chain right, Compare& comp) {
+        BaseNode merged;
+        BaseNode* out = &merged;
+        BaseNode* a = left.first;
+        BaseNode* b = right.first;
+        while (a != nullptr && b != nullptr) {
+            if (comp(static_cast<Node*>(b)->val, static_cast<Node*>(a)->val)) {
+                out->next = b;
+                b = b->next;
+            } else {
+                out->next = a;
+                a = a->next;
+            }
+            out = out->next;
+        }
+        out->next = a != nullptr ? a : b;
+        return {merged.next, a != nullptr ? left.last : right.last};
+    }
+
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using iterator = list_detail::NodeIterator<T, BaseNode, false>;
+    using const_iterator = list_detail::NodeIterator<T, BaseNode, true>;
+
+    using Base::get_allocator;
+    using Base::size;
+
+    constexpr ForwardList() = default;
+    constexpr ForwardList(const Alloc& external_allocator)
+        : Base(external_allocator) {}
+
+    constexpr ForwardList(size_t n, const T& el,
+                          const Alloc& external_allocator = Alloc())
+        : Base(external_allocator) {
+        try {
+            while (sz < n) {
+                push_back(el);
+            }
+        } catch (...) {
+            clear();
+            throw;
+        }
+    }
+
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    constexpr ForwardList(InputIt first, Sentinel last,
+                          const Alloc& external_allocator = Alloc())
+        : Base(external_allocator) {
+        construct_from(first, last);
+    }
+
+    constexpr ForwardList(const ForwardList& another)
+        : Base(NodeAllocTraits::select_on_container_copy_construction(
+              another.allocator)) {
+        construct_from(another.cbegin(), another.cend());
+    }
+
+    constexpr ForwardList(ForwardList&& another) noexcept
+        : Base(another.allocator) {
+        steal(another);
+    }
+
+    constexpr ~ForwardList() {
+        clear();
+    }
+
+    constexpr ForwardList& operator=(const ForwardList& another) {
+        Base::copy_assign(another);
+        return *this;
+    }
+
+    // Same policy as List; see NodeContainer::move_assign.
+    constexpr ForwardList& operator=(ForwardList&& another) noexcept(
+        Base::kNothrowMoveAssign) {
+        Base::move_assign(another);
+        return *this;
+    }
+
+    constexpr void swap(ForwardList& another) {
+        std::swap(head.next, another.head.next);
+        std::swap(tail, another.tail);
+        std::swap(sz, another.sz);
+        if (sz == 0) {
+            tail = &head;
+        }
+        if (another.sz == 0) {
+            another.tail = &another.head;
+        }
+        if (NodeAllocTraits::propagate_on_container_swap::value) {
+            std::swap(allocator, another.allocator);
+        }
+    }
+
+    constexpr void clear() noexcept {
+        BaseNode* cur = head.next;
+        while (cur != nullptr) {
+            Node* node = static_cast<Node*>(cur);
+            cur = cur->next;
+            destroy_node(node);
+        }
+        reset();
+    }
+
+    constexpr iterator before_begin() {
+        return iterator(&head);
+    }
+    constexpr const_iterator before_begin() const {
+        return cbefore_begin();
+    }
+    constexpr const_iterator cbefore_begin() const {
+        return const_iterator(&head);
+    }
+
+    constexpr iterator begin() {
+        return iterator(head.next);
+    }
+    constexpr const_iterator begin() const {
+        return cbegin();
+    }
+    constexpr const_iterator cbegin() const {
+        return const_iterator(head.next);
+    }
+
+    constexpr iterator end() {
+        return iterator(nullptr);
+    }
+    constexpr const_iterator end() const {
+        return cend();
+    }
+    constexpr const_iterator cend() const {
+        return const_iterator(nullptr);
+    }
+
+    // The last element; the list must not be empty.
+    constexpr T& back() {
+        return static_cast<Node*>(tail)->val;
+    }
+    constexpr const T& back() const {
+        return static_cast<const Node*>(tail)->val;
+    }
+
+    template <typename... Args>
+    constexpr iterator emplace_after(const_iterator it, Args&&... args) {
+        Node* node = make_node(std::in_place, std::forward<Args>(args)...);
+        link_after(unconst(it), node, node, 1);
+        return iterator(node);
+    }
+
+    constexpr iterator insert_after(const_iterator it, const T& el) {
+        return emplace_after(it, el);
+    }
+    constexpr iterator insert_after(const_iterator it, T&& el) {
+        return emplace_after(it, std::move(el));
+    }
+
+    // Builds the new nodes aside and links them in only once all of them are
+    // constructed, so a throwing element leaves the list untouched.
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    constexpr void insert_after(const_iterator it, InputIt first, Sentinel last) {
+        ForwardList chain(allocator);
+        chain.construct_from(first, last);
+        splice_after(it, chain);
+    }
+
+    template <typename... Args>
+    constexpr T& emplace_front(Args&&... args) {
+        return *emplace_after(cbefore_begin(), std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    constexpr T& emplace_back(Args&&... args) {
+        return *emplace_after(const_iterator(tail), std::forward<Args>(args)...);
+    }
+
+    constexpr void push_front(const T& el) {
+        emplace_front(el);
+    }
+    constexpr void push_front(T&& el) {
+        emplace_front(std::move(el));
+    }
+    constexpr void push_back(const T& el) {
+        emplace_back(el);
+    }
+    constexpr void push_back(T&& el) {
+        emplace_back(std::move(el));
+    }
+
+    constexpr void pop_front() {
+        erase_after(cbefore_begin());
+    }
+
+    // Erases the element after it and returns the one that followed it.
+    constexpr iterator erase_after(const_iterator it) {
+        BaseNode* prev = unconst(it);
+        Node* node = static_cast<Node*>(prev->next);
+        prev->next = node->next;
+        if (tail == node) {
+            tail = prev;
+        }
+        --sz;
+        destroy_node(node);
+        return iterator(prev->next);
+    }
+
+    // Erases (first, last).
+    constexpr iterator erase_after(const_iterator first, const_iterator last) {
+        while (std::next(first) != last) {
+            erase_after(first);
+        }
+        return iterator(unconst(last));
+    }
+
+    // Moves all nodes of another after it without copying elements; the
+    // allocators must compare equal.
+    constexpr void splice_after(const_iterator it, ForwardList& another) noexcept {
+        if (another.sz == 0) {
+            return;
+        }
+        link_after(unconst(it), another.head.next, another.tail, another.sz);
+        another.reset();
+    }
+
+    // Moves the node after before of another to after it; the allocators
+    // must compare equal.
+    constexpr void splice_after(const_iterator it, ForwardList& another,
+                                const_iterator before) noexcept {
+        BaseNode* prev = unconst(it);
+        BaseNode* from = unconst(before);
+        BaseNode* node = from->next;
+        if (prev == from || prev == node) {
+            return;
+        }
+        from->next = node->next;
+        if (another.tail == node) {
+            another.tail = from;
+        }
+        --another.sz;
+        link_after(prev, node, node, 1);
+    }
+
+    // Stable merge sort that only relinks nodes: O(n log n) comparisons, no
+    // allocation. Sorted runs of 2^i nodes wait in bins[i] and are merged as
+    // soon as a second run of that size appears, so most merges work on
+    // nodes that were touched moments ago and are still in cache.
+    template <typename Compare = std::less<>>
+    constexpr void sort(Compare comp = Compare()) {
+        if (sz < 2) {
+            return;
+        }
+        constexpr size_t kBins = 64;
+        Chain bins[kBins] = {};
+        size_t used = 0;
+        BaseNode* rest = head.next;
+        while (rest != nullptr) {
+            Chain carry{rest, rest};
+            rest = rest->next;
+            carry.first->next = nullptr;
+            size_t i = 0;
+            for (; i < used && bins[i].first != nullptr; ++i) {
+                carry = merge(bins[i], carry, comp);
+                bins[i] = Chain{};
+            }
+            bins[i] = carry;
+            if (i == used) {
+                ++used;
+            }
+        }
+        Chain result;
+        for (size_t i = 0; i < used; ++i) {
+            if (bins[i].first != nullptr) {
+                result = result.first == nullptr ? bins[i]
+                                                 : merge(bins[i], result, comp);
+            }
+        }
+        head.next = result.first;
+        tail = result.last;
+    }
+};
@@ -1,213 +1,238 @@
 #pragma once
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <ranges>
 #include <type_traits>
+#include <utility>
+
+#include "node_container.h"
+
+namespace list_detail {
+template <typename ListType>
+struct NodeAccess;
+}  // namespace list_detail
 
 template <typename T, typename Alloc = std::allocator<T>>
-class List {
+class List : private list_detail::NodeContainer<List<T, Alloc>, T, Alloc,
+                                                list_detail::ListLinks> {
   private:
-    struct BaseNode {
-        BaseNode* next = this;  // or nullptr
-        BaseNode* prev = this;  // or nullptr
-    };
-    struct Node : BaseNode {
-        T val;
-        Node(const T& value) noexcept(std::is_nothrow_copy_constructible_v<T>)
-            : val(value) {}
-        Node() noexcept(std::is_nothrow_default_constructible_v<T>) = default;
-        Node(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>)
-            : val(std::move(value)) {}  // noexcept is not necessary so that's it
-    };
-
-    using NodeAlloc =
-        typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
-    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
-
-    [[no_unique_address]] NodeAlloc allocator;
-    size_t sz = 0;
+    using Base =
+        list_detail::NodeContainer<List<T, Alloc>, T, Alloc, list_detail::ListLinks>;
+    friend Base;
+    // The scanning kernels of list_algorithms.h walk the nodes directly.
+    friend struct list_detail::NodeAccess<List>;
+
+    using typename Base::BaseNode;
+    using typename Base::Node;
+    using typename Base::NodeAlloc;
+    using typename Base::NodeAllocTraits;
+    using Base::allocator;
+    using Base::destroy_node;
+    using Base::make_node;
+    using Base::steal;
+    using Base::sz;
+    using Base::unconst;
+
+    // Copying an element cannot throw and is a plain byte copy when T is
+    // trivially copyable and the allocator does not hook construct().
+    static constexpr bool kTrivialCopy =
+        std::is_trivially_copyable_v<T> &&
+        !requires(NodeAlloc& alloc, Node* node, const T& el) {
+            alloc.construct(node, std::in_place, el);
+        };
+
+    // The allocator lets nodes of one allocate(n) block be deallocated one
+    // by one, as a bump allocator does, so a batch of nodes can be carved
+    // from a single allocation.
+    static constexpr bool kBulkAllocate =
+        requires { requires NodeAlloc::deallocates_piecewise::value; };
+
     BaseNode fakeNode;
 
-    void default_push() {
-        Node* new_node = NodeAllocTraits::allocate(allocator, 1);
+    constexpr void default_push() {
+        Node* new_node = make_node();
+        ++sz;
+        // prev is read through next, as emplace does, rather than written
+        // as &fakeNode: GCC takes the latter for a local's address escaping
+        // into the arena and fails -Werror=dangling-pointer.
+        BaseNode* next = fakeNode.next;
+        new_node->next = next;
+        new_node->prev = next->prev;
+        next->prev = new_node;
+        fakeNode.next = new_node;
+    }
+
+    // Appends count elements read from first, which yields T. Only the
+    // allocation can fail, so the nodes are chained in one forward pass and
+    // the ring is closed once at the end, without the per-element
+    // bookkeeping of push_back. With kBulkAllocate all nodes come from one
+    // allocate(count), back to back, and values from a contiguous source
+    // are memcpy-ed straight into them when T needs no initialization. On
+    // exception the nodes built so far stay.
+    template <typename InputIt>
+    constexpr void append_trivial(InputIt first, size_t count) {
+        Node* block = nullptr;
+        if constexpr (kBulkAllocate) {
+            if (!std::is_constant_evaluated() && count != 0) {
+                block = NodeAllocTraits::allocate(allocator, count);
+            }
+        }
+        BaseNode* tail = fakeNode.prev;
         try {
-            NodeAllocTraits::construct(allocator, new_node);
+            for (size_t i = 0; i < count; ++i, ++first) {
+                Node* node = block != nullptr
+                                 ? block + i
+                                 : NodeAllocTraits::allocate(allocator, 1);
+                if constexpr (std::contiguous_iterator<InputIt> &&
+                              std::is_trivially_default_constructible_v<T>) {
+                    if (!std::is_constant_evaluated()) {
+                        std::construct_at(node, nullptr);
+                        std::memcpy(&node->val, std::to_address(first), sizeof(T));
+                    } else {
+                        NodeAllocTraits::construct(allocator, node, std::in_place,
+                                                   *first);
+                    }
+                } else {
+                    NodeAllocTraits::construct(allocator, node, std::in_place,
+                                               *first);
+                }
+                node->prev = tail;
+                tail->next = node;
+                tail = node;
+                ++sz;
+            }
         } catch (...) {
-            NodeAllocTraits::deallocate(allocator, new_node, 1);
+            tail->next = &fakeNode;
+            fakeNode.prev = tail;
             throw;
         }
-        ++sz;
-        new_node->next = fakeNode.next;
-        new_node->prev = &fakeNode;
-        fakeNode.next->prev = new_node;
-        fakeNode.next = new_node;
+        tail->next = &fakeNode;
+        fakeNode.prev = tail;
     }
 
-    template <bool IsConst>
-    class CommonIterator {
-      private:
-        friend List;
-        // std::conditional_t<IsConst, const BaseNode*, BaseNode*> node_ptr =
-        // nullptr;
-        BaseNode* node_ptr = nullptr;
-
-      public:
-        using value_type = std::conditional_t<IsConst, const T, T>;
-        using reference = std::conditional_t<IsConst, const T&, T&>;
-        using pointer = std::conditional_t<IsConst, const T*, T*>;
-        using difference_type = ptrdiff_t;
-        using iterator_category = std::bidirectional_iterator_tag;
-        // real ok in iterator_traits
-
-        CommonIterator() = default;
-        CommonIterator(BaseNode* node_ptr)
-            : node_ptr(node_ptr) {}
-        CommonIterator(const CommonIterator&) = default;
-
-        CommonIterator& operator=(const CommonIterator&) = default;
-        operator CommonIterator<true>() const {
-            return CommonIterator<true>(node_ptr);
+    // Sized ranges of trivially copyable T take the one-pass path.
+    template <typename InputIt, typename Sentinel>
+    constexpr void construct_from(InputIt first, Sentinel last) {
+        if constexpr (kTrivialCopy && std::sized_sentinel_for<Sentinel, InputIt> &&
+                      std::is_same_v<std::iter_value_t<InputIt>, T>) {
+            try {
+                append_trivial(first, static_cast<size_t>(last - first));
+            } catch (...) {
+                clear();
+                throw;
+            }
+        } else {
+            Base::construct_from(first, last);
         }
+    }
 
-        CommonIterator& operator++() {
-            node_ptr = node_ptr->next;
-            return *this;
+    constexpr void copy_from(const List& another) {
+        if constexpr (kTrivialCopy) {
+            try {
+                append_trivial(another.cbegin(), another.sz);
+            } catch (...) {
+                clear();
+                throw;
+            }
+        } else {
+            Base::copy_from(another);
         }
+    }
 
-        CommonIterator operator++(int) {
-            auto copy = *this;
-            node_ptr = node_ptr->next;
-            return copy;
-        }
+    constexpr void take_links(List& another) noexcept {
+        fakeNode = another.fakeNode;
+        fakeNode.next->prev = fakeNode.prev->next = &fakeNode;
+        another.fakeNode.next = another.fakeNode.prev = &another.fakeNode;
+    }
 
-        CommonIterator& operator--() {
-            node_ptr = node_ptr->prev;
-            return *this;
+    constexpr void truncate(size_t n) {
+        while (sz > n) {
+            pop_back();
         }
+    }
 
-        CommonIterator operator--(int) {
-            auto copy = *this;
-            node_ptr = node_ptr->prev;
-            return copy;
-        }
+    constexpr void splice_back(List& another) noexcept {
+        splice(cend(), another);
+    }
 
-        bool operator==(const CommonIterator&) const = default;
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using iterator = list_detail::NodeIterator<T, BaseNode, false>;
+    using const_iterator = list_detail::NodeIterator<T, BaseNode, true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-        reference operator*() const {
-            Node* real = static_cast<Node*>(node_ptr);
-            return real->val;
-        }
+    using Base::get_allocator;
+    using Base::size;
 
-        pointer operator->() const {
-            Node* real = static_cast<Node*>(node_ptr);
-            return &(real->val);
-        }
-    };
+    constexpr List()
+        : fakeNode{&fakeNode, &fakeNode} {}
+    constexpr List(const Alloc& external_allocator)
+        : Base(external_allocator), fakeNode{&fakeNode, &fakeNode} {}
 
-  public:
-    List()
-        : allocator{}, fakeNode{&fakeNode, &fakeNode} {}
-    List(const Alloc& external_allocator)
-        : allocator(external_allocator), fakeNode{&fakeNode, &fakeNode} {}
-
-    List(size_t n, const T& el, const Alloc& external_allocator = Alloc())
-        : allocator(external_allocator), fakeNode{&fakeNode, &fakeNode} {
-        while (sz < n) {
-            try {
+    constexpr List(size_t n, const T& el, const Alloc& external_allocator = Alloc())
+        : Base(external_allocator), fakeNode{&fakeNode, &fakeNode} {
+        try {
+            while (sz < n) {
                 push_back(el);
-            } catch (...) {
-                while (sz != 0u) {
-                    pop_back();
-                }
-                throw;
             }
+        } catch (...) {
+            clear();
+            throw;
         }
     }
 
-    List(size_t n, const Alloc& external_allocator = Alloc())
-        : allocator(external_allocator), fakeNode{&fakeNode, &fakeNode} {
-        while (sz < n) {
-            try {
+    constexpr List(size_t n, const Alloc& external_allocator = Alloc())
+        : Base(external_allocator), fakeNode{&fakeNode, &fakeNode} {
+        try {
+            while (sz < n) {
                 default_push();
-            } catch (...) {
-                while (sz != 0u) {
-                    pop_back();
-                }
-                throw;
             }
+        } catch (...) {
+            clear();
+            throw;
         }
     }
 
-    NodeAlloc get_allocator() const {
-        return allocator;
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    constexpr List(InputIt first, Sentinel last,
+                   const Alloc& external_allocator = Alloc())
+        : Base(external_allocator), fakeNode{&fakeNode, &fakeNode} {
+        construct_from(first, last);
     }
 
-    List(const List& another)
-        : allocator(NodeAllocTraits::select_on_container_copy_construction(
+    constexpr List(const List& another)
+        : Base(NodeAllocTraits::select_on_container_copy_construction(
               another.allocator)),
           fakeNode{&fakeNode, &fakeNode} {
-        const_iterator it = another.cbegin();
-        while (it != another.cend()) {
-            try {
-                push_back(*it);
-                ++it;
-            } catch (...) {
-                while (sz != 0u) {
-                    pop_back();
-                }
-                throw;
-            }
-        }
+        copy_from(another);
     }
 
-    List(List&& another)
-        : allocator(std::move(another.allocator)),
-          sz(another.sz),
-          fakeNode{&fakeNode, &fakeNode} {
-        if (sz != 0u) {
-            fakeNode = another.fakeNode;
-            another.sz = 0;
-            another.fakeNode = {&another.fakeNode, &another.fakeNode};
-        }
+    constexpr List(List&& another) noexcept
+        : Base(another.allocator), fakeNode{&fakeNode, &fakeNode} {
+        steal(another);
     }
 
-    ~List() {
-        while (sz != 0u) {
-            pop_back();
-        }
+    constexpr ~List() {
+        clear();
     }
 
-    List& operator=(const List& another) {
-        List copy(allocator);
-        const_iterator it = another.cbegin();
-        while (it != another.cend()) {
-            try {
-                copy.push_back(*it);
-                ++it;
-            } catch (...) {
-                while (copy.size()) {
-                    copy.pop_back();
-                }
-                throw;
-            }
-        }
-        swap(copy);
-        if (NodeAllocTraits::propagate_on_container_copy_assignment::value) {
-            allocator = another.allocator;
-        }
+    constexpr List& operator=(const List& another) {
+        Base::copy_assign(another);
         return *this;
     }
 
-    List& operator=(List&& another) {
-        List copy(std::move(another));
-        swap(copy);
-        if (!NodeAllocTraits::propagate_on_container_swap::value &&
-            NodeAllocTraits::propagate_on_move_assignment::value) {
-            std::swap(allocator, copy.allocator);
-        }
+    // Steals the node ring in O(1) when the allocators allow it, otherwise
+    // moves the elements into our own nodes; see NodeContainer::move_assign.
+    constexpr List& operator=(List&& another) noexcept(Base::kNothrowMoveAssign) {
+        Base::move_assign(another);
         return *this;
     }
 
-    void swap(List& another) {
+    constexpr void swap(List& another) {
         std::swap(sz, another.sz);
         std::swap(fakeNode, another.fakeNode);
         if (sz == 0) {
@@ -226,96 +251,192 @@ class List {
         }
     }
 
-    size_t size() const {
-        return sz;
+    // Frees every node in one walk over the ring, without relinking
+    // neighbours the way repeated pop_back() would.
+    constexpr void clear() noexcept {
+        BaseNode* cur = fakeNode.next;
+        while (cur != &fakeNode) {
+            Node* node = static_cast<Node*>(cur);
+            cur = cur->next;
+            destroy_node(node);
+        }
+        sz = 0;
+        fakeNode.next = fakeNode.prev = &fakeNode;
     }
 
-    void push_back(const T& el) {
+    constexpr void push_back(const T& el) {
         insert(end(), el);
     }
-    void push_front(const T& el) {
+    constexpr void push_back(T&& el) {
+        insert(end(), std::move(el));
+    }
+    constexpr void push_front(const T& el) {
         insert(begin(), el);
     }
-    void pop_back() {
+    constexpr void push_front(T&& el) {
+        insert(begin(), std::move(el));
+    }
+
+    template <typename... Args>
+    constexpr T& emplace_back(Args&&... args) {
+        return *emplace(end(), std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    constexpr T& emplace_front(Args&&... args) {
+        return *emplace(begin(), std::forward<Args>(args)...);
+    }
+    constexpr void pop_back() {
         erase(--end());
     }
-    void pop_front() {
+    constexpr void pop_front() {
         erase(begin());
     }
 
-    using iterator =
-        CommonIterator<false>;  // std::iterator_traits<CommonIterator<false>>;
-    using const_iterator =
-        CommonIterator<true>;  // std::iterator_traits<CommonIterator<true>>;
-    using reverse_iterator = std::reverse_iterator<iterator>;
-    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
-
-    iterator begin() {
+    constexpr iterator begin() {
         return iterator(fakeNode.next);
     }
-    const_iterator begin() const {
+    constexpr const_iterator begin() const {
         return cbegin();
     }
-    const_iterator cbegin() const {
+    constexpr const_iterator cbegin() const {
         return const_iterator(fakeNode.next);
     }
 
-    iterator end() {
+    constexpr iterator end() {
         return iterator(&fakeNode);
     }
-    const_iterator end() const {
+    constexpr const_iterator end() const {
         return cend();
     }
-    const_iterator cend() const {
-        return const_iterator(fakeNode.next->prev);
+    constexpr const_iterator cend() const {
+        return const_iterator(&fakeNode);
     }
 
-    reverse_iterator rbegin() {
+    constexpr reverse_iterator rbegin() {
         return std::reverse_iterator(end());
     }
-    const_reverse_iterator rbegin() const {
+    constexpr const_reverse_iterator rbegin() const {
         return crbegin();
     }
-    const_reverse_iterator crbegin() const {
+    constexpr const_reverse_iterator crbegin() const {
         return std::reverse_iterator(cend());
     }
 
-    reverse_iterator rend() {
+    constexpr reverse_iterator rend() {
         return std::reverse_iterator(begin());
     }
-    const_reverse_iterator rend() const {
+    constexpr const_reverse_iterator rend() const {
         return crend();
     }
-    const_reverse_iterator crend() const {
+    constexpr const_reverse_iterator crend() const {
         return std::reverse_iterator(cbegin());
     }
 
-    void insert(const_iterator it, const T& el) {
-        Node* new_node = NodeAllocTraits::allocate(allocator, 1);
-        try {
-            NodeAllocTraits::construct(allocator, new_node, el);
-        } catch (...) {
-            NodeAllocTraits::deallocate(allocator, new_node, 1);
-            throw;
-        }
+    constexpr void insert(const_iterator it, const T& el) {
+        emplace(it, el);
+    }
+    constexpr void insert(const_iterator it, T&& el) {
+        emplace(it, std::move(el));
+    }
+
+    template <typename... Args>
+    constexpr iterator emplace(const_iterator it, Args&&... args) {
+        Node* new_node = make_node(std::in_place, std::forward<Args>(args)...);
         ++sz;
 
-        BaseNode* prev = it.node_ptr->prev;
+        BaseNode* next = unconst(it);
+        BaseNode* prev = next->prev;
         prev->next = new_node;
-        it.node_ptr->prev = new_node;
+        next->prev = new_node;
 
-        new_node->next = it.node_ptr;
+        new_node->next = next;
         new_node->prev = prev;
+        return iterator(new_node);
+    }
+
+    // Builds the new nodes aside and links them in only once all of them are
+    // constructed, so a throwing element leaves the list untouched.
+    template <std::input_iterator InputIt, std::sentinel_for<InputIt> Sentinel>
+    constexpr void insert(const_iterator it, InputIt first, Sentinel last) {
+        List chain(allocator);
+        chain.construct_from(first, last);
+        splice(it, chain);
     }
 
-    void erase(const_iterator it) {
+    // Moves all nodes of another in front of it without copying elements;
+    // the allocators must compare equal.
+    constexpr void splice(const_iterator it, List& another) noexcept {
+        if (another.sz == 0) {
+            return;
+        }
+        BaseNode* first = another.fakeNode.next;
+        BaseNode* last = another.fakeNode.prev;
+        BaseNode* next = unconst(it);
+        BaseNode* prev = next->prev;
+
+        prev->next = first;
+        first->prev = prev;
+        last->next = next;
+        next->prev = last;
+
+        sz += another.sz;
+        another.sz = 0;
+        another.fakeNode.next = another.fakeNode.prev = &another.fakeNode;
+    }
+
+    // Moves the single node at pos of another in front of it; the
+    // allocators must compare equal.
+    constexpr void splice(const_iterator it, List& another,
+                          const_iterator pos) noexcept {
+        BaseNode* node = unconst(pos);
+        BaseNode* next = unconst(it);
+        if (node == next || node->next == next) {
+            return;
+        }
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        --another.sz;
+
+        BaseNode* prev = next->prev;
+        prev->next = node;
+        node->prev = prev;
+        node->next = next;
+        next->prev = node;
+        ++sz;
+    }
+
+    constexpr void erase(const_iterator it) {
         --sz;
-        Node* node_to_delete = static_cast<Node*>(it.node_ptr);
+        Node* node_to_delete = static_cast<Node*>(unconst(it));
         BaseNode* prev = node_to_delete->prev;
         BaseNode* next = node_to_delete->next;
         prev->next = next;
         next->prev = prev;
-        NodeAllocTraits::destroy(allocator, node_to_delete);
-        NodeAllocTraits::deallocate(allocator, node_to_delete, 1);
+        destroy_node(node_to_delete);
+    }
+};
+
+// Pipeable `range | to_list<List<T>>()`, standing in for C++23
+// std::ranges::to: the range is consumed in one pass by the iterator-pair
+// constructor, with no intermediate container.
+template <typename ListType>
+struct ToList {
+    typename ListType::allocator_type allocator;
+
+    template <std::ranges::input_range R>
+    constexpr ListType operator()(R&& range) const {
+        return ListType(std::ranges::begin(range), std::ranges::end(range),
+                        allocator);
     }
-};
\ No newline at end of file
+
+    template <std::ranges::input_range R>
+    friend constexpr ListType operator|(R&& range, const ToList& to) {
+        return to(std::forward<R>(range));
+    }
+};
+
+template <typename ListType>
+constexpr ToList<ListType> to_list(
+    const typename ListType::allocator_type& allocator = {}) {
+    return ToList<ListType>{allocator};
+}
\ No newline at end of file
@@ -0,0 +1,596 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "list.h"
+
+// Scanning algorithms over List that exploit nodes lying back to back in
+// memory, as a StackAllocator arena hands them out.
+//
+// Plain iteration is bound by load latency: the address of every node comes
+// out of the previous node's next pointer. Here a node's successor is
+// instead predicted to sit right after it, and the prediction is checked by
+// comparing next with that address. The next load then only feeds a
+// branch, so the CPU runs ahead along a run of adjacent nodes instead of
+// waiting for every load. Nodes are consumed in blocks whose links have all
+// been checked; on x86 the values of a block of 32-bit ints are processed
+// with AVX2 (8 nodes, gathered) or SSE4.1 (4 nodes), picked at run time.
+// Where the prediction fails the walk follows next as usual, so scattered
+// nodes cost what pointer chasing does.
+
+namespace list_detail {
+
+template <typename T, typename Alloc>
+struct NodeAccess<List<T, Alloc>> {
+    using Node = typename List<T, Alloc>::Node;
+    using BaseNode = typename List<T, Alloc>::BaseNode;
+
+    static const BaseNode* fake(const List<T, Alloc>& lst) {
+        return &lst.fakeNode;
+    }
+};
+
+enum class Isa { kScalar, kSse41, kAvx2 };
+
+inline Isa best_isa() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const Isa isa = __builtin_cpu_supports("avx2")     ? Isa::kAvx2
+                           : __builtin_cpu_supports("sse4.1") ? Isa::kSse41
+                                                              : Isa::kScalar;
+    return isa;
+#else
+    return Isa::kScalar;
+#endif
+}
+
+template <typename ListType>
+class NodeWalk {
+  private:
+    using Node = typename NodeAccess<ListType>::Node;
+    using BaseNode = typename NodeAccess<ListType>::BaseNode;
+
+    const BaseNode* fake;
+
+  public:
+    explicit NodeWalk(const ListType& lst)
+        : fake(NodeAccess<ListType>::fake(lst)) {}
+
+    // The node stored right after node. Only valid once links_to_next(node)
+    // said that node's successor really is there.
+    static const Node* after(const Node* node) {
+        return std::launder(reinterpret_cast<const Node*>(
+            reinterpret_cast<const char*>(node) + sizeof(Node)));
+    }
+
+    static const Node* after(const Node* node, size_t k) {
+        return std::launder(reinterpret_cast<const Node*>(
+            reinterpret_cast<const char*>(node) + k * sizeof(Node)));
+    }
+
+    bool links_to_next(const Node* node) const {
+        auto next = reinterpret_cast<std::uintptr_t>(node->next);
+        return next - reinterpret_cast<std::uintptr_t>(node) == sizeof(Node) &&
+               node->next != fake;
+    }
+
+    // Calls block(first) for every K adjacent nodes whose last one also
+    // links to the node right after it, and single(node) for the nodes in
+    // between. Every address is computed from the first node of the block
+    // rather than taken from a next pointer, so the loads only feed the
+    // checks; the checks short-circuit, so nothing is read from a node
+    // before its predecessor was seen to link to it. Either callback
+    // returns false to stop.
+    template <size_t K, typename Block, typename Single>
+    void operator()(Block&& block, Single&& single) const {
+        const BaseNode* cur = fake->next;
+        while (cur != fake) {
+            const Node* node = static_cast<const Node*>(cur);
+            while (links_block(node, std::make_index_sequence<K>())) {
+                if (!block(node)) {
+                    return;
+                }
+                node = after(node, K);
+            }
+            if (!single(node)) {
+                return;
+            }
+            while (links_to_next(node)) {
+                node = after(node);
+                if (!single(node)) {
+                    return;
+                }
+            }
+            cur = node->next;
+        }
+    }
+
+  private:
+    template <size_t... I>
+    bool links_block(const Node* node, std::index_sequence<I...> /*unused*/) const {
+        return (links_to_next(after(node, I)) && ...);
+    }
+};
+
+// The SIMD kernels take 32-bit ints only; everything else is scalar.
+template <typename T>
+constexpr bool kSimdValue = std::is_same_v<T, int>;
+
+template <typename ListType, typename T>
+typename ListType::const_iterator find(const ListType& lst, const T& value, Isa isa);
+template <typename ListType, typename T>
+size_t count(const ListType& lst, const T& value, Isa isa);
+template <typename ListType, typename U>
+U accumulate(const ListType& lst, U init, Isa isa);
+template <typename ListType>
+std::pair<typename ListType::value_type, typename ListType::value_type> minmax(
+    const ListType& lst, Isa isa);
+
+// Scalar kernels: blocks of 8 nodes are summed or compared in an unrolled
+// loop.
+template <typename ListType>
+struct ScalarKernels {
+    using T = typename ListType::value_type;
+    using Walk = NodeWalk<ListType>;
+    static constexpr size_t kBlock = 8;
+
+    static const void* find(const ListType& lst, const T& value) {
+        const void* found = nullptr;
+        auto single = [&](const auto* node) {
+            if (node->val == value) {
+                found = node;
+                return false;
+            }
+            return true;
+        };
+        Walk(lst).template operator()<kBlock>(
+            [&](const auto* node) {
+                for (size_t i = 0; i < kBlock; ++i, node = Walk::after(node)) {
+                    if (!single(node)) {
+                        return false;
+                    }
+                }
+                return true;
+            },
+            single);
+        return found;
+    }
+
+    static size_t count(const ListType& lst, const T& value) {
+        size_t total = 0;
+        auto single = [&](const auto* node) {
+            total += static_cast<size_t>(node->val == value);
+            return true;
+        };
+        Walk(lst).template operator()<kBlock>(
+            [&](const auto* node) {
+                size_t matches = 0;
+                for (size_t i = 0; i < kBlock; ++i, node = Walk::after(node)) {
+                    matches += static_cast<size_t>(node->val == value);
+                }
+                total += matches;
+                return true;
+            },
+            single);
+        return total;
+    }
+
+    template <typename U>
+    static U accumulate(const ListType& lst, U init) {
+        auto single = [&](const auto* node) {
+            init = std::move(init) + node->val;
+            return true;
+        };
+        Walk(lst).template operator()<kBlock>(
+            [&](const auto* node) {
+                for (size_t i = 0; i < kBlock; ++i, node = Walk::after(node)) {
+                    init = std::move(init) + node->val;
+                }
+                return true;
+            },
+            single);
+        return init;
+    }
+
+    static void minmax(const ListType& lst, std::pair<T, T>& result) {
+        auto single = [&](const auto* node) {
+            if (node->val < result.first) {
+                result.first = node->val;
+            }
+            if (result.second < node->val) {
+                result.second = node->val;
+            }
+            return true;
+        };
+        Walk(lst).template operator()<kBlock>(
+            [&](const auto* node) {
+                for (size_t i = 0; i < kBlock; ++i, node = Walk::after(node)) {
+                    single(node);
+                }
+                return true;
+            },
+            single);
+    }
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// The block callbacks below carry the ISA as a target attribute, and the
+// entry points are flattened so the walk and its callbacks inline into
+// code compiled for that ISA.
+
+template <typename ListType>
+struct Avx2Kernels {
+    using Node = typename NodeAccess<ListType>::Node;
+    using Walk = NodeWalk<ListType>;
+    static constexpr size_t kBlock = 8;
+    static constexpr int kStride = sizeof(Node) / sizeof(int);
+
+    struct Gather {
+        __attribute__((target("avx2"))) static __m256i values(const Node* node) {
+            const __m256i index =
+                _mm256_setr_epi32(0, kStride, 2 * kStride, 3 * kStride, 4 * kStride,
+                                  5 * kStride, 6 * kStride, 7 * kStride);
+            return _mm256_i32gather_epi32(&node->val, index, sizeof(int));
+        }
+    };
+
+    struct FindBlock {
+        __m256i needle;
+        const void*& found;
+
+        __attribute__((target("avx2"))) bool operator()(const Node* node) const {
+            __m256i equal = _mm256_cmpeq_epi32(Gather::values(node), needle);
+            auto mask = static_cast<unsigned>(
+                _mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+            if (mask == 0) {
+                return true;
+            }
+            found = Walk::after(node, static_cast<size_t>(std::countr_zero(mask)));
+            return false;
+        }
+    };
+
+    struct CountBlock {
+        __m256i needle;
+        size_t& total;
+
+        __attribute__((target("avx2"))) bool operator()(const Node* node) const {
+            __m256i equal = _mm256_cmpeq_epi32(Gather::values(node), needle);
+            total += static_cast<size_t>(std::popcount(static_cast<unsigned>(
+                _mm256_movemask_ps(_mm256_castsi256_ps(equal)))));
+            return true;
+        }
+    };
+
+    struct SumBlock {
+        __m256i& sum;  // four 64-bit lanes
+
+        __attribute__((target("avx2"))) bool operator()(const Node* node) const {
+            __m256i values = Gather::values(node);
+            sum = _mm256_add_epi64(
+                sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+            sum = _mm256_add_epi64(
+                sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+            return true;
+        }
+    };
+
+    struct MinMaxBlock {
+        __m256i& lo;
+        __m256i& hi;
+
+        __attribute__((target("avx2"))) bool operator()(const Node* node) const {
+            __m256i values = Gather::values(node);
+            lo = _mm256_min_epi32(lo, values);
+            hi = _mm256_max_epi32(hi, values);
+            return true;
+        }
+    };
+
+    __attribute__((target("avx2"), flatten)) static const void* find(
+        const ListType& lst, int value) {
+        const void* found = nullptr;
+        Walk(lst).template operator()<kBlock>(
+            FindBlock{_mm256_set1_epi32(value), found}, [&](const Node* node) {
+                if (node->val == value) {
+                    found = node;
+                    return false;
+                }
+                return true;
+            });
+        return found;
+    }
+
+    __attribute__((target("avx2"), flatten)) static size_t count(
+        const ListType& lst, int value) {
+        size_t total = 0;
+        Walk(lst).template operator()<kBlock>(
+            CountBlock{_mm256_set1_epi32(value), total}, [&](const Node* node) {
+                total += static_cast<size_t>(node->val == value);
+                return true;
+            });
+        return total;
+    }
+
+    __attribute__((target("avx2"), flatten)) static int64_t sum(
+        const ListType& lst) {
+        __m256i lanes = _mm256_setzero_si256();
+        int64_t rest = 0;
+        Walk(lst).template operator()<kBlock>(SumBlock{lanes}, [&](const Node* node) {
+            rest += node->val;
+            return true;
+        });
+        alignas(32) int64_t parts[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(parts), lanes);
+        return rest + parts[0] + parts[1] + parts[2] + parts[3];
+    }
+
+    __attribute__((target("avx2"), flatten)) static void minmax(
+        const ListType& lst, std::pair<int, int>& result) {
+        __m256i lo = _mm256_set1_epi32(result.first);
+        __m256i hi = _mm256_set1_epi32(result.second);
+        Walk(lst).template operator()<kBlock>(MinMaxBlock{lo, hi}, [&](const Node* node) {
+            result.first = node->val < result.first ? node->val : result.first;
+            result.second = result.second < node->val ? node->val : result.second;
+            return true;
+        });
+        alignas(32) int los[8];
+        alignas(32) int his[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(los), lo);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(his), hi);
+        for (size_t i = 0; i < 8; ++i) {
+            result.first = los[i] < result.first ? los[i] : result.first;
+            result.second = result.second < his[i] ? his[i] : result.second;
+        }
+    }
+};
+
+// SSE4.1 has no gather, so a block of 4 values is assembled from scalar
+// loads; the comparisons and reductions are vector ones.
+template <typename ListType>
+struct Sse41Kernels {
+    using Node = typename NodeAccess<ListType>::Node;
+    using Walk = NodeWalk<ListType>;
+    static constexpr size_t kBlock = 4;
+
+    struct Load {
+        __attribute__((target("sse4.1"))) static __m128i values(const Node* node) {
+            const Node* second = Walk::after(node);
+            const Node* third = Walk::after(second);
+            return _mm_setr_epi32(node->val, second->val, third->val,
+                                  Walk::after(third)->val);
+        }
+    };
+
+    struct FindBlock {
+        __m128i needle;
+        const void*& found;
+
+        __attribute__((target("sse4.1"))) bool operator()(const Node* node) const {
+            __m128i equal = _mm_cmpeq_epi32(Load::values(node), needle);
+            auto mask =
+                static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(equal)));
+            if (mask == 0) {
+                return true;
+            }
+            found = Walk::after(node, static_cast<size_t>(std::countr_zero(mask)));
+            return false;
+        }
+    };
+
+    struct CountBlock {
+        __m128i needle;
+        size_t& total;
+
+        __attribute__((target("sse4.1"))) bool operator()(const Node* node) const {
+            __m128i equal = _mm_cmpeq_epi32(Load::values(node), needle);
+            total += static_cast<size_t>(std::popcount(
+                static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(equal)))));
+            return true;
+        }
+    };
+
+    struct SumBlock {
+        __m128i& sum;  // two 64-bit lanes
+
+        __attribute__((target("sse4.1"))) bool operator()(const Node* node) const {
+            __m128i values = Load::values(node);
+            sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(values));
+            sum = _mm_add_epi64(sum, _mm_cvtepi32_epi64(_mm_srli_si128(values, 8)));
+            return true;
+        }
+    };
+
+    struct MinMaxBlock {
+        __m128i& lo;
+        __m128i& hi;
+
+        __attribute__((target("sse4.1"))) bool operator()(const Node* node) const {
+            __m128i values = Load::values(node);
+            lo = _mm_min_epi32(lo, values);
+            hi = _mm_max_epi32(hi, values);
+            return true;
+        }
+    };
+
+    __attribute__((target("sse4.1"), flatten)) static const void* find(
+        const ListType& lst, int value) {
+        const void* found = nullptr;
+        Walk(lst).template operator()<kBlock>(
+            FindBlock{_mm_set1_epi32(value), found}, [&](const Node* node) {
+                if (node->val == value) {
+                    found = node;
+                    return false;
+                }
+                return true;
+            });
+        return found;
+    }
+
+    __attribute__((target("sse4.1"), flatten)) static size_t count(
+        const ListType& lst, int value) {
+        size_t total = 0;
+        Walk(lst).template operator()<kBlock>(
+            CountBlock{_mm_set1_epi32(value), total}, [&](const Node* node) {
+                total += static_cast<size_t>(node->val == value);
+                return true;
+            });
+        return total;
+    }
+
+    __attribute__((target("sse4.1"), flatten)) static int64_t sum(
+        const ListType& lst) {
+        __m128i lanes = _mm_setzero_si128();
+        int64_t rest = 0;
+        Walk(lst).template operator()<kBlock>(SumBlock{lanes}, [&](const Node* node) {
+            rest += node->val;
+            return true;
+        });
+        alignas(16) int64_t parts[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(parts), lanes);
+        return rest + parts[0] + parts[1];
+    }
+
+    __attribute__((target("sse4.1"), flatten)) static void minmax(
+        const ListType& lst, std::pair<int, int>& result) {
+        __m128i lo = _mm_set1_epi32(result.first);
+        __m128i hi = _mm_set1_epi32(result.second);
+        Walk(lst).template operator()<kBlock>(MinMaxBlock{lo, hi}, [&](const Node* node) {
+            result.first = node->val < result.first ? node->val : result.first;
+            result.second = result.second < node->val ? node->val : result.second;
+            return true;
+        });
+        alignas(16) int los[4];
+        alignas(16) int his[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(los), lo);
+        _mm_store_si128(reinterpret_cast<__m128i*>(his), hi);
+        for (size_t i = 0; i < 4; ++i) {
+            result.first = los[i] < result.first ? los[i] : result.first;
+            result.second = result.second < his[i] ? his[i] : result.second;
+        }
+    }
+};
+
+#endif  // __x86_64__ || __i386__
+
+// The entry points below take the ISA explicitly, so tests and benchmarks
+// can run every kernel; the list_* functions use best_isa().
+
+template <typename ListType, typename T>
+typename ListType::const_iterator find(const ListType& lst, const T& value,
+                                       [[maybe_unused]] Isa isa) {
+    using BaseNode = typename NodeAccess<ListType>::BaseNode;
+    const void* found = nullptr;
+#if defined(__x86_64__) || defined(__i386__)
+    if constexpr (kSimdValue<typename ListType::value_type>) {
+        if (isa == Isa::kAvx2) {
+            found = Avx2Kernels<ListType>::find(lst, value);
+        } else if (isa == Isa::kSse41) {
+            found = Sse41Kernels<ListType>::find(lst, value);
+        } else {
+            found = ScalarKernels<ListType>::find(lst, value);
+        }
+    } else {
+        found = ScalarKernels<ListType>::find(lst, value);
+    }
+#else
+    found = ScalarKernels<ListType>::find(lst, value);
+#endif
+    if (found == nullptr) {
+        return lst.cend();
+    }
+    using Node = typename NodeAccess<ListType>::Node;
+    return typename ListType::const_iterator(
+        static_cast<const BaseNode*>(static_cast<const Node*>(found)));
+}
+
+template <typename ListType, typename T>
+size_t count(const ListType& lst, const T& value, [[maybe_unused]] Isa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    if constexpr (kSimdValue<typename ListType::value_type>) {
+        if (isa == Isa::kAvx2) {
+            return Avx2Kernels<ListType>::count(lst, value);
+        }
+        if (isa == Isa::kSse41) {
+            return Sse41Kernels<ListType>::count(lst, value);
+        }
+    }
+#endif
+    return ScalarKernels<ListType>::count(lst, value);
+}
+
+template <typename ListType, typename U>
+U accumulate(const ListType& lst, U init, [[maybe_unused]] Isa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    // The vector sums are 64 bits wide, so only a 64-bit integer result
+    // comes out the same as the scalar loop.
+    if constexpr (kSimdValue<typename ListType::value_type> &&
+                  std::is_integral_v<U> && sizeof(U) == sizeof(int64_t)) {
+        if (isa == Isa::kAvx2) {
+            return init + static_cast<U>(Avx2Kernels<ListType>::sum(lst));
+        }
+        if (isa == Isa::kSse41) {
+            return init + static_cast<U>(Sse41Kernels<ListType>::sum(lst));
+        }
+    }
+#endif
+    return ScalarKernels<ListType>::accumulate(lst, std::move(init));
+}
+
+template <typename ListType>
+std::pair<typename ListType::value_type, typename ListType::value_type> minmax(
+    const ListType& lst, [[maybe_unused]] Isa isa) {
+    if (lst.size() == 0) {
+        throw std::out_of_range("list_minmax: empty list");
+    }
+    using T = typename ListType::value_type;
+    std::pair<T, T> result{*lst.cbegin(), *lst.cbegin()};
+#if defined(__x86_64__) || defined(__i386__)
+    if constexpr (kSimdValue<T>) {
+        if (isa == Isa::kAvx2) {
+            Avx2Kernels<ListType>::minmax(lst, result);
+            return result;
+        }
+        if (isa == Isa::kSse41) {
+            Sse41Kernels<ListType>::minmax(lst, result);
+            return result;
+        }
+    }
+#endif
+    ScalarKernels<ListType>::minmax(lst, result);
+    return result;
+}
+
+}  // namespace list_detail
+
+template <typename T, typename Alloc>
+typename List<T, Alloc>::const_iterator list_find(const List<T, Alloc>& lst,
+                                                  const T& value) {
+    return list_detail::find(lst, value, list_detail::best_isa());
+}
+
+template <typename T, typename Alloc>
+size_t list_count(const List<T, Alloc>& lst, const T& value) {
+    return list_detail::count(lst, value, list_detail::best_isa());
+}
+
+template <typename T, typename Alloc, typename U>
+U list_accumulate(const List<T, Alloc>& lst, U init) {
+    return list_detail::accumulate(lst, std::move(init), list_detail::best_isa());
+}
+
+// Returns {min, max} over a non-empty list.
+template <typename T, typename Alloc>
+std::pair<T, T> list_minmax(const List<T, Alloc>& lst) {
+    return list_detail::minmax(lst, list_detail::best_isa());
+}
@@ -0,0 +1,794 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <ranges>
+#include <shared_mutex>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent_list.h"
+#include "forward_list.h"
+#include "list.h"
+#include "list_algorithms.h"
+#include "list_channel.h"
+#include "list_merge.h"
+#include "list_serialization.h"
+#include "snapshot_list.h"
+#include "perf_counters.h"
+#include "stack_allocator.h"
+#include "vector.h"
+
+constexpr size_t STORAGE_SIZE = 400'000'000;
+StackStorage<STORAGE_SIZE> STATIC_STORAGE;  // NOLINT
+
+constexpr size_t ARENA_SIZE = 100'000'000;
+StackStorage<ARENA_SIZE> FIRST_ARENA;   // NOLINT
+StackStorage<ARENA_SIZE> SECOND_ARENA;  // NOLINT
+
+template <size_t Size>
+struct Payload {
+    char bytes[Size] = {};
+};
+
+using std::chrono::duration;
+using std::chrono::high_resolution_clock;
+
+template <typename F>
+double MeasureNs(size_t elements, F&& body) {
+    auto start = high_resolution_clock::now();
+    body();
+    auto finish = high_resolution_clock::now();
+    return duration<double, std::nano>(finish - start).count() /
+           static_cast<double>(elements);
+}
+
+void PrintRow(const std::string& name, size_t size, const std::string& op,
+              double ns) {
+    std::cout << std::setw(10) << name << std::setw(8) << size << std::setw(10)
+              << op << std::setw(12) << std::fixed << std::setprecision(2)
+              << ns << " ns/elem\n";
+}
+
+// Wall time plus per-element hardware counters for one operation; columns
+// whose counter could not be opened print as n/a.
+template <typename F>
+void CountersRow(PerfCounters& counters, const std::string& name,
+                 const std::string& op, size_t elements, F&& body) {
+    counters.start();
+    double ns = MeasureNs(elements, body);
+    auto readings = counters.stop(static_cast<double>(elements));
+
+    std::cout << std::setw(10) << name << std::setw(10) << op
+              << std::setw(10) << std::fixed << std::setprecision(2) << ns;
+    for (const auto& reading : readings) {
+        if (reading.available) {
+            std::cout << std::setw(11) << std::setprecision(3)
+                      << reading.value;
+        } else {
+            std::cout << std::setw(11) << "n/a";
+        }
+    }
+    std::cout << '\n';
+}
+
+template <typename Alloc>
+void CountersBench(PerfCounters& counters, const std::string& name, size_t n,
+                   Alloc alloc) {
+    auto lst = std::make_unique<List<int, Alloc>>(alloc);
+    CountersRow(counters, name, "push", n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            lst->push_back(static_cast<int>(i));
+        }
+    });
+
+    auto middle = std::next(lst->cbegin(), static_cast<ptrdiff_t>(n / 2));
+    CountersRow(counters, name, "insert", n, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            lst->insert(middle, static_cast<int>(i));
+        }
+    });
+
+    long long sum = 0;
+    CountersRow(counters, name, "iterate", 2 * n, [&] {
+        for (int x : *lst) {
+            sum += x;
+        }
+    });
+
+    CountersRow(counters, name, "copy", 2 * n, [&] {
+        List<int, Alloc> copy = *lst;
+        sum += static_cast<long long>(copy.size());
+    });
+
+    CountersRow(counters, name, "erase", n, [&] {
+        auto it = lst->cbegin();
+        for (size_t i = 0; i < n; ++i) {
+            lst->erase(it++);
+            ++it;
+        }
+    });
+
+    CountersRow(counters, name, "destroy", n, [&] { lst.reset(); });
+
+    if (sum == 1) {
+        std::cout << "";
+    }
+}
+
+void HardwareCountersBench(size_t n) {
+    PerfCounters counters;
+    if (!counters.any_available()) {
+        std::cout << "(perf_event_open unavailable, wall time only)\n";
+    }
+    std::cout << std::setw(10) << "alloc" << std::setw(10) << "op"
+              << std::setw(10) << "ns";
+    for (const auto& event : PerfCounters::default_events()) {
+        std::cout << std::setw(11) << event.name;
+    }
+    std::cout << "  (per element)\n";
+
+    CountersBench(counters, "std", n, std::allocator<int>());
+    STATIC_STORAGE.shift = 0;
+    CountersBench(counters, "stack", n,
+                  StackAllocator<int, STORAGE_SIZE>(STATIC_STORAGE));
+    STATIC_STORAGE.shift = 0;
+}
+
+template <typename T, typename Alloc>
+void NodeLayoutBench(const std::string& name, size_t n, Alloc alloc) {
+    List<T, Alloc> lst(alloc);
+    PrintRow(name, sizeof(T), "push", MeasureNs(n, [&] {
+                 for (size_t i = 0; i < n; ++i) {
+                     lst.push_back(T());
+                 }
+             }));
+
+    size_t checksum = 0;
+    PrintRow(name, sizeof(T), "iterate", MeasureNs(n, [&] {
+                 for (const T& el : lst) {
+                     checksum += static_cast<unsigned char>(
+                         reinterpret_cast<const char&>(el));
+                 }
+             }));
+
+    PrintRow(name, sizeof(T), "copy", MeasureNs(n, [&] {
+                 List<T, Alloc> copy = lst;
+                 checksum += copy.size();
+             }));
+
+    PrintRow(name, sizeof(T), "clear",
+             MeasureNs(n, [&] { lst.clear(); }));
+
+    if (checksum == 1) {
+        std::cout << "";
+    }
+}
+
+template <size_t Size>
+void NodeLayoutMatrix(size_t n) {
+    using T = Payload<Size>;
+    NodeLayoutBench<T>("std", n, std::allocator<T>());
+
+    STATIC_STORAGE.shift = 0;
+    NodeLayoutBench<T>("stack", n,
+                       StackAllocator<T, STORAGE_SIZE>(STATIC_STORAGE));
+    STATIC_STORAGE.shift = 0;
+}
+
+void SerializationBench(size_t n) {
+    using Alloc = StackAllocator<int, STORAGE_SIZE>;
+    STATIC_STORAGE.shift = 0;
+
+    List<int, Alloc> lst{Alloc(STATIC_STORAGE)};
+    for (size_t i = 0; i < n; ++i) {
+        lst.push_back(static_cast<int>(i));
+    }
+
+    std::stringstream stream;
+    PrintRow("dump", sizeof(int), "write",
+             MeasureNs(n, [&] { write_list(stream, lst); }));
+    std::string bytes = stream.str();
+
+    PrintRow("dump", sizeof(int), "push", MeasureNs(n, [&] {
+                 List<int, Alloc> rebuilt{Alloc(STATIC_STORAGE)};
+                 for (int x : lst) {
+                     rebuilt.push_back(x);
+                 }
+             }));
+
+    PrintRow("dump", sizeof(int), "read", MeasureNs(n, [&] {
+                 List<int, Alloc> loaded{Alloc(STATIC_STORAGE)};
+                 read_list(stream, loaded);
+             }));
+
+    size_t sum = 0;
+    PrintRow("dump", sizeof(int), "view", MeasureNs(n, [&] {
+                 ListDumpView<int> view(bytes);
+                 for (int x : view) {
+                     sum += static_cast<size_t>(x);
+                 }
+             }));
+    if (sum == 1) {
+        std::cout << "";
+    }
+    STATIC_STORAGE.shift = 0;
+}
+
+void RangesBench(size_t n) {
+    List<int> lst;
+    for (size_t i = 0; i < n; ++i) {
+        lst.push_back(static_cast<int>(i));
+    }
+    auto is_even = [](int x) { return x % 2 == 0; };
+    auto triple = [](int x) { return x * 3; };
+
+    long long loop_sum = 0;
+    PrintRow("loop", sizeof(int), "sum", MeasureNs(n, [&] {
+                 for (int x : lst) {
+                     if (is_even(x)) {
+                         loop_sum += triple(x);
+                     }
+                 }
+             }));
+
+    long long view_sum = 0;
+    PrintRow("ranges", sizeof(int), "sum", MeasureNs(n, [&] {
+                 for (int x : lst | std::views::filter(is_even) |
+                                  std::views::transform(triple)) {
+                     view_sum += x;
+                 }
+             }));
+
+    size_t loop_size = 0;
+    PrintRow("loop", sizeof(int), "collect", MeasureNs(n, [&] {
+                 List<int> out;
+                 for (int x : lst) {
+                     if (is_even(x)) {
+                         out.push_back(triple(x));
+                     }
+                 }
+                 loop_size = out.size();
+             }));
+
+    size_t view_size = 0;
+    PrintRow("ranges", sizeof(int), "collect", MeasureNs(n, [&] {
+                 List<int> out = lst | std::views::filter(is_even) |
+                                 std::views::transform(triple) |
+                                 to_list<List<int>>();
+                 view_size = out.size();
+             }));
+
+    if (loop_sum != view_sum || loop_size != view_size) {
+        std::cout << "ranges and loop results differ\n";
+    }
+}
+
+template <typename Alloc>
+void BulkAlgorithmsBench(const std::string& name, size_t n, size_t passes,
+                         Alloc alloc) {
+    List<int, Alloc> lst(alloc);
+    for (size_t i = 0; i < n; ++i) {
+        lst.push_back(static_cast<int>(i % 1'000));
+    }
+
+    long long chased = 0;
+    PrintRow(name, n, "sum/chase", MeasureNs(n * passes, [&] {
+                 for (size_t pass = 0; pass < passes; ++pass) {
+                     for (int x : lst) {
+                         chased += x;
+                     }
+                 }
+             }));
+
+    size_t chased_count = 0;
+    PrintRow(name, n, "cnt/chase", MeasureNs(n * passes, [&] {
+                 for (size_t pass = 0; pass < passes; ++pass) {
+                     chased_count += static_cast<size_t>(
+                         std::count(lst.begin(), lst.end(), 7));
+                 }
+             }));
+
+    using list_detail::Isa;
+    const std::pair<Isa, std::string> kernels[] = {
+        {Isa::kScalar, "scal"}, {Isa::kSse41, "sse4"}, {Isa::kAvx2, "avx2"}};
+    bool differ = false;
+    for (const auto& [isa, isa_name] : kernels) {
+        if (isa > list_detail::best_isa()) {
+            continue;
+        }
+        long long sum = 0;
+        PrintRow(name, n, "sum/" + isa_name, MeasureNs(n * passes, [&] {
+                     for (size_t pass = 0; pass < passes; ++pass) {
+                         sum += list_detail::accumulate(lst, 0LL, isa);
+                     }
+                 }));
+        size_t count = 0;
+        PrintRow(name, n, "cnt/" + isa_name, MeasureNs(n * passes, [&] {
+                     for (size_t pass = 0; pass < passes; ++pass) {
+                         count += list_detail::count(lst, 7, isa);
+                     }
+                 }));
+        differ = differ || sum != chased || count != chased_count;
+    }
+
+    if (differ) {
+        std::cout << "kernel results differ\n";
+    }
+}
+
+template <typename Alloc>
+void BulkAlgorithmsMatrix(const std::string& name, Alloc alloc) {
+    // Cache resident and memory bound.
+    BulkAlgorithmsBench(name, 20'000, 500, alloc);
+    BulkAlgorithmsBench(name, 1'000'000, 1, alloc);
+}
+
+void MoveAssignmentBench(size_t n) {
+    using Alloc = StackAllocator<int, ARENA_SIZE>;
+    auto fill = [n](List<int, Alloc>& lst) {
+        for (size_t i = 0; i < n; ++i) {
+            lst.push_back(static_cast<int>(i));
+        }
+    };
+
+    {
+        List<int, Alloc> lst{Alloc(FIRST_ARENA)};
+        List<int, Alloc> same{Alloc(FIRST_ARENA)};
+        fill(same);
+        PrintRow("same", sizeof(int), "move=",
+                 MeasureNs(n, [&] { lst = std::move(same); }));
+    }
+    {
+        List<int, Alloc> lst{Alloc(FIRST_ARENA)};
+        List<int, Alloc> other{Alloc(SECOND_ARENA)};
+        fill(other);
+        PrintRow("cross", sizeof(int), "move=",
+                 MeasureNs(n, [&] { lst = std::move(other); }));
+    }
+    {
+        List<int, Alloc> lst{Alloc(FIRST_ARENA)};
+        fill(lst);
+        List<int, Alloc> other{Alloc(SECOND_ARENA)};
+        fill(other);
+        PrintRow("reuse", sizeof(int), "move=",
+                 MeasureNs(n, [&] { lst = std::move(other); }));
+    }
+    FIRST_ARENA.shift = 0;
+    SECOND_ARENA.shift = 0;
+}
+
+Task BenchProducer(Channel<int>& ch, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        co_await ch.push(static_cast<int>(i));
+    }
+    ch.close();
+}
+
+Task BenchConsumer(Channel<int>& ch, std::atomic<size_t>& received) {
+    while (std::optional<int> value = co_await ch.pop()) {
+        received.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// The same bounded queue done the classic way: a List guarded by a mutex
+// and two condition variables, one thread on each side.
+double MutexQueueNs(size_t n, size_t capacity) {
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    List<int> queue;
+
+    return MeasureNs(n, [&] {
+        std::thread consumer([&] {
+            for (size_t i = 0; i < n; ++i) {
+                std::unique_lock lock(mutex);
+                not_empty.wait(lock, [&] { return queue.size() != 0; });
+                queue.pop_front();
+                lock.unlock();
+                not_full.notify_one();
+            }
+        });
+        for (size_t i = 0; i < n; ++i) {
+            std::unique_lock lock(mutex);
+            not_full.wait(lock, [&] { return queue.size() < capacity; });
+            queue.push_back(static_cast<int>(i));
+            lock.unlock();
+            not_empty.notify_one();
+        }
+        consumer.join();
+    });
+}
+
+void ChannelBench(size_t n) {
+    constexpr size_t kCapacity = 64;
+    {
+        InlineScheduler scheduler;
+        Channel<int> ch(scheduler, kCapacity);
+        std::atomic<size_t> received = 0;
+        PrintRow("inline", kCapacity, "msg=", MeasureNs(n, [&] {
+                     spawn(scheduler, BenchConsumer(ch, received));
+                     spawn(scheduler, BenchProducer(ch, n));
+                     scheduler.run();
+                 }));
+    }
+    {
+        std::atomic<size_t> received = 0;
+        auto scheduler = std::make_unique<ThreadPoolScheduler>(2);
+        Channel<int> ch(*scheduler, kCapacity);
+        PrintRow("pool", kCapacity, "msg=", MeasureNs(n, [&] {
+                     spawn(*scheduler, BenchConsumer(ch, received));
+                     spawn(*scheduler, BenchProducer(ch, n));
+                     while (received.load(std::memory_order_relaxed) != n) {
+                         std::this_thread::yield();
+                     }
+                 }));
+        scheduler.reset();
+    }
+    PrintRow("mutex+cv", kCapacity, "msg=", MutexQueueNs(n, kCapacity));
+}
+
+// Readers keep summing the whole list while one writer replaces the front
+// element every kWritePause, all until the same deadline; reports ns per
+// element read and the writer's own time per write.
+template <typename Reader, typename Writer>
+void ReadersBench(const std::string& name, size_t readers, Reader read,
+                  Writer write) {
+    constexpr auto kDuration = std::chrono::milliseconds(300);
+    constexpr auto kWritePause = std::chrono::microseconds(20);
+    auto deadline = high_resolution_clock::now() + kDuration;
+    std::atomic<size_t> elements_read = 0;
+    size_t writes = 0;
+    double write_ns = 0;
+
+    std::vector<std::thread> threads;
+    for (size_t r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            size_t local = 0;
+            while (high_resolution_clock::now() < deadline) {
+                local += read();
+            }
+            elements_read += local;
+        });
+    }
+    while (high_resolution_clock::now() < deadline) {
+        write_ns += MeasureNs(1, write);
+        ++writes;
+        std::this_thread::sleep_for(kWritePause);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    double ns = duration<double, std::nano>(kDuration).count();
+    PrintRow(name, readers, "read",
+             ns * static_cast<double>(readers) /
+                 static_cast<double>(elements_read.load()));
+    PrintRow(name, readers, "write", write_ns / static_cast<double>(writes));
+}
+
+void SnapshotReadersBench(size_t n) {
+    for (size_t readers : {1, 2, 4}) {
+        SnapshotList<int> snapshot_list;
+        for (size_t i = 0; i < n; ++i) {
+            snapshot_list.push_back(static_cast<int>(i));
+        }
+        ReadersBench(
+            "snapshot", readers,
+            [&] {
+                auto snapshot = snapshot_list.snapshot();
+                size_t count = 0;
+                long long sum = 0;
+                for (int el : snapshot) {
+                    sum += el;
+                    ++count;
+                }
+                return count + static_cast<size_t>(sum == 1);
+            },
+            [&] {
+                auto snapshot = snapshot_list.snapshot();
+                snapshot_list.push_back(*snapshot.begin());
+                snapshot_list.erase(snapshot.begin());
+            });
+
+        std::shared_mutex mutex;
+        List<int> lst;
+        for (size_t i = 0; i < n; ++i) {
+            lst.push_back(static_cast<int>(i));
+        }
+        ReadersBench(
+            "rwlock", readers,
+            [&] {
+                std::shared_lock lock(mutex);
+                long long sum = 0;
+                for (int el : lst) {
+                    sum += el;
+                }
+                return lst.size() + static_cast<size_t>(sum == 1);
+            },
+            [&] {
+                std::unique_lock lock(mutex);
+                lst.push_back(*lst.begin());
+                lst.pop_front();
+            });
+    }
+}
+
+// Append-only growth on an arena: std::vector abandons every buffer it
+// grows out of, Vector extends the top block in place.
+void VectorGrowthBench(size_t n) {
+    using Alloc = StackAllocator<int, ARENA_SIZE>;
+    auto report = [n](const std::string& name, double ns) {
+        PrintRow(name, sizeof(int), "push", ns);
+        std::cout << std::setw(28) << "arena used " << FIRST_ARENA.shift
+                  << " bytes for " << n * sizeof(int) << "\n";
+        FIRST_ARENA.shift = 0;
+    };
+
+    {
+        std::vector<int, Alloc> vec{Alloc(FIRST_ARENA)};
+        report("std", MeasureNs(n, [&] {
+                   for (size_t i = 0; i < n; ++i) {
+                       vec.push_back(static_cast<int>(i));
+                   }
+               }));
+    }
+    {
+        Vector<int, Alloc> vec{Alloc(FIRST_ARENA)};
+        report("Vector", MeasureNs(n, [&] {
+                   for (size_t i = 0; i < n; ++i) {
+                       vec.push_back(static_cast<int>(i));
+                   }
+               }));
+    }
+}
+
+// Queue-style use of both lists on an arena: fill, walk, drain from the
+// front; arena bytes show the per-node cost of the second link.
+template <typename ListType>
+void QueueBench(const std::string& name, size_t n) {
+    using Alloc = StackAllocator<int, ARENA_SIZE>;
+    auto lst = std::make_unique<ListType>(Alloc(FIRST_ARENA));
+    PrintRow(name, sizeof(int), "push", MeasureNs(n, [&] {
+                 for (size_t i = 0; i < n; ++i) {
+                     lst->push_back(static_cast<int>(i));
+                 }
+             }));
+    std::cout << std::setw(28) << "arena used " << FIRST_ARENA.shift
+              << " bytes\n";
+    long long sum = 0;
+    PrintRow(name, sizeof(int), "iterate", MeasureNs(n, [&] {
+                 for (int el : *lst) {
+                     sum += el;
+                 }
+             }));
+    PrintRow(name, sizeof(int), "pop", MeasureNs(n, [&] {
+                 for (size_t i = 0; i < n; ++i) {
+                     lst->pop_front();
+                 }
+             }));
+    if (sum == 1) {
+        std::cout << "";
+    }
+    FIRST_ARENA.shift = 0;
+}
+
+void ForwardListBench(size_t n) {
+    using Alloc = StackAllocator<int, ARENA_SIZE>;
+    QueueBench<List<int, Alloc>>("List", n);
+    QueueBench<ForwardList<int, Alloc>>("Forward", n);
+
+    ForwardList<int, Alloc> lst{Alloc(FIRST_ARENA)};
+    unsigned state = 1;
+    for (size_t i = 0; i < n; ++i) {
+        state = state * 1'103'515'245 + 12'345;
+        lst.push_back(static_cast<int>(state >> 8));
+    }
+    PrintRow("Forward", sizeof(int), "sort", MeasureNs(n, [&] { lst.sort(); }));
+    FIRST_ARENA.shift = 0;
+}
+
+// Combines sorted lists three ways: the old way, a heap over the
+// fronts feeding push_back into a fresh list, then merge_k relinking the
+// nodes, sequentially and as a tree of merges.
+void MergeKBench(size_t lists_count, size_t per_list) {
+    using Lists = std::vector<List<int>>;
+    auto make_lists = [&] {
+        Lists lists(lists_count);
+        unsigned state = 1;
+        for (List<int>& lst : lists) {
+            int value = 0;
+            for (size_t i = 0; i < per_list; ++i) {
+                state = state * 1'103'515'245 + 12'345;
+                value += static_cast<int>(state >> 28);
+                lst.push_back(value);
+            }
+        }
+        return lists;
+    };
+    size_t total = lists_count * per_list;
+
+    {
+        Lists lists = make_lists();
+        List<int> merged;
+        PrintRow("heap+push", lists_count, "merge", MeasureNs(total, [&] {
+                     using Front = std::pair<int, size_t>;
+                     std::priority_queue<Front, std::vector<Front>,
+                                         std::greater<>> heap;
+                     std::vector<List<int>::const_iterator> pos;
+                     for (size_t i = 0; i < lists.size(); ++i) {
+                         pos.push_back(lists[i].cbegin());
+                         heap.emplace(*pos[i], i);
+                     }
+                     while (!heap.empty()) {
+                         auto [value, i] = heap.top();
+                         heap.pop();
+                         merged.push_back(value);
+                         if (++pos[i] != lists[i].cend()) {
+                             heap.emplace(*pos[i], i);
+                         }
+                     }
+                 }));
+    }
+    {
+        Lists lists = make_lists();
+        List<int> merged;
+        PrintRow("merge_k", lists_count, "merge", MeasureNs(total, [&] {
+                     merged = merge_k(std::span(lists));
+                 }));
+    }
+    {
+        Lists lists = make_lists();
+        List<int> merged;
+        size_t threads = std::max(2u, std::thread::hardware_concurrency());
+        PrintRow("parallel", lists_count, "merge", MeasureNs(total, [&] {
+                     merged = merge_k_parallel(std::span(lists), threads);
+                 }));
+    }
+}
+
+// Runs ops operations split over threads and prints the wall time per
+// operation, so a structure that scales prints smaller numbers for more
+// threads. op(state, i) gets a per-thread random state.
+template <typename Op>
+void MixedBench(const std::string& name, size_t threads, size_t ops, Op op) {
+    auto start = high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            unsigned state = static_cast<unsigned>(t) + 1;
+            for (size_t i = t; i < ops; i += threads) {
+                state = state * 1'103'515'245 + 12'345;
+                op(state >> 16, i);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double ns = duration<double, std::nano>(high_resolution_clock::now() - start)
+                    .count();
+    PrintRow(name, threads, "mixed", ns / static_cast<double>(ops));
+}
+
+// Each operation walks up to kReach elements from the front, then inserts
+// or erases there at random; one in kScanEvery scans the whole list
+// instead.
+void ConcurrentListBench(size_t n, size_t ops) {
+    constexpr unsigned kReach = 128;
+    constexpr size_t kScanEvery = 256;
+    std::atomic<long long> checksum = 0;
+
+    for (size_t threads : {1, 2, 4}) {
+        ConcurrentList<int> concurrent;
+        for (size_t i = 0; i < n; ++i) {
+            concurrent.push_back(static_cast<int>(i));
+        }
+        MixedBench("per-node", threads, ops, [&](unsigned random, size_t i) {
+            if (i % kScanEvery == 0) {
+                long long sum = 0;
+                concurrent.for_each([&](int el) { sum += el; });
+                checksum += sum;
+                return;
+            }
+            auto it = concurrent.begin();
+            for (unsigned step = random % kReach;
+                 step > 0 && it != concurrent.end(); --step) {
+                ++it;
+            }
+            if (random / kReach % 2 == 0 && it != concurrent.end()) {
+                concurrent.erase(it);
+            } else {
+                concurrent.insert(it, static_cast<int>(i));
+            }
+        });
+
+        std::mutex mutex;
+        List<int> lst;
+        for (size_t i = 0; i < n; ++i) {
+            lst.push_back(static_cast<int>(i));
+        }
+        MixedBench("global", threads, ops, [&](unsigned random, size_t i) {
+            std::lock_guard lock(mutex);
+            if (i % kScanEvery == 0) {
+                long long sum = 0;
+                for (int el : lst) {
+                    sum += el;
+                }
+                checksum += sum;
+                return;
+            }
+            auto it = lst.begin();
+            for (unsigned step = random % kReach; step > 0 && it != lst.end();
+                 --step) {
+                ++it;
+            }
+            if (random / kReach % 2 == 0 && it != lst.end()) {
+                lst.erase(it);
+            } else {
+                lst.insert(it, static_cast<int>(i));
+            }
+        });
+    }
+    if (checksum == 1) {
+        std::cout << "";
+    }
+}
+
+int main() {
+    constexpr size_t kElements = 1'000'000;
+
+    std::cout << "Node layout matrix over sizeof(T)\n";
+    NodeLayoutMatrix<1>(kElements);
+    NodeLayoutMatrix<8>(kElements);
+    NodeLayoutMatrix<32>(kElements);
+    NodeLayoutMatrix<48>(kElements);
+    NodeLayoutMatrix<64>(kElements);
+    NodeLayoutMatrix<256>(kElements / 4);
+
+    std::cout << "\nSerialization\n";
+    SerializationBench(kElements);
+
+    std::cout << "\nRanges pipeline vs hand-written loop\n";
+    RangesBench(kElements);
+
+    std::cout << "\nRun-aware bulk algorithms\n";
+    BulkAlgorithmsMatrix("std", std::allocator<int>());
+    STATIC_STORAGE.shift = 0;
+    BulkAlgorithmsMatrix("stack",
+                         StackAllocator<int, STORAGE_SIZE>(STATIC_STORAGE));
+    STATIC_STORAGE.shift = 0;
+
+    std::cout << "\nMove assignment within and across arenas\n";
+    MoveAssignmentBench(kElements);
+
+    std::cout << "\nHardware counters per operation\n";
+    HardwareCountersBench(kElements);
+
+    std::cout << "\nCoroutine channel vs mutex queue, ns per message\n";
+    ChannelBench(kElements);
+
+    std::cout << "\nSnapshot readers vs shared_mutex, 1 writer\n";
+    SnapshotReadersBench(10'000);
+
+    std::cout << "\nVector growth on an arena\n";
+    VectorGrowthBench(kElements);
+
+    std::cout << "\nForwardList vs List as a queue\n";
+    ForwardListBench(kElements);
+
+    std::cout << "\nMerging 256 sorted lists of 100k\n";
+    MergeKBench(256, 100'000);
+
+    std::cout << "\nConcurrent list, mixed insert/erase/scan, ns per op\n";
+    ConcurrentListBench(10'000, 200'000);
+}
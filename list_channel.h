@@ -0,0 +1,425 @@
+#pragma once
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "list.h"
+
+// Where resumed coroutines go: a channel never resumes a waiter inline, it
+// hands the handle to the scheduler the channel was created with.
+class Scheduler {
+  public:
+    virtual ~Scheduler() = default;
+    virtual void schedule(std::coroutine_handle<> handle) = 0;
+};
+
+// Runs everything on the calling thread, in FIFO order, until no coroutine
+// is ready any more.
+class InlineScheduler : public Scheduler {
+  private:
+    List<std::coroutine_handle<>> ready;
+
+  public:
+    void schedule(std::coroutine_handle<> handle) override {
+        ready.push_back(handle);
+    }
+
+    void run() {
+        while (ready.size() != 0) {
+            std::coroutine_handle<> handle = *ready.begin();
+            ready.pop_front();
+            handle.resume();
+        }
+    }
+};
+
+// A fixed set of worker threads sharing one ready queue. The destructor
+// lets the workers finish what is queued and joins them; coroutines still
+// suspended on a channel at that point are not resumed.
+class ThreadPoolScheduler : public Scheduler {
+  private:
+    std::mutex mutex;
+    std::condition_variable has_work;
+    List<std::coroutine_handle<>> ready;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void work() {
+        std::unique_lock lock(mutex);
+        while (true) {
+            has_work.wait(lock, [this] { return stopping || ready.size() != 0; });
+            if (ready.size() == 0) {
+                return;
+            }
+            std::coroutine_handle<> handle = *ready.begin();
+            ready.pop_front();
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+        }
+    }
+
+  public:
+    ThreadPoolScheduler(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            workers.emplace_back([this] { work(); });
+        }
+    }
+
+    ThreadPoolScheduler(const ThreadPoolScheduler&) = delete;
+    ThreadPoolScheduler& operator=(const ThreadPoolScheduler&) = delete;
+
+    ~ThreadPoolScheduler() override {
+        {
+            std::lock_guard lock(mutex);
+            stopping = true;
+        }
+        has_work.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void schedule(std::coroutine_handle<> handle) override {
+        {
+            std::lock_guard lock(mutex);
+            ready.push_back(handle);
+        }
+        has_work.notify_one();
+    }
+};
+
+// Fire-and-forget coroutine. It starts suspended and runs once spawn()
+// hands it to a scheduler; its frame is freed when the body finishes.
+class Task {
+  public:
+    struct promise_type {
+        Task get_return_object() {
+            return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+
+  private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : handle(handle) {}
+
+    friend void spawn(Scheduler& scheduler, Task task);
+
+  public:
+    Task(Task&& another) noexcept
+        : handle(std::exchange(another.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task& operator=(Task&&) = delete;
+
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+};
+
+inline void spawn(Scheduler& scheduler, Task task) {
+    scheduler.schedule(std::exchange(task.handle, nullptr));
+}
+
+// Bounded multi-producer multi-consumer channel of T for coroutines:
+// `co_await ch.push(x)` suspends while the channel is full, and
+// `co_await ch.pop()` suspends while it is empty.
+//
+// Values travel inside List nodes: a push fills a node, and that node is
+// spliced into the buffer or straight into a waiting consumer, so no
+// element is copied on the way. Consumed nodes go back to a spare list
+// and later pushes reuse them, so a channel in steady state does not
+// allocate. Lists returned by pop_all() belong to the caller; hand them to
+// recycle() to keep their nodes in the channel. All allocation happens
+// under the channel lock, which keeps a (thread-unsafe) StackAllocator
+// usable even with ThreadPoolScheduler.
+template <typename T, typename Alloc = std::allocator<T>>
+class Channel {
+  private:
+    using Nodes = List<T, Alloc>;
+
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        Nodes nodes;  // the value to deliver, or the values received
+        bool batch = false;
+        bool closed = false;
+        Waiter* next = nullptr;
+
+        Waiter(const Alloc& alloc)
+            : nodes(alloc) {}
+    };
+
+    // Intrusive FIFO of waiters; they live in the awaiting coroutine frames.
+    struct WaiterQueue {
+        Waiter* head = nullptr;
+        Waiter* tail = nullptr;
+
+        bool empty() const {
+            return head == nullptr;
+        }
+
+        void push(Waiter* waiter) {
+            waiter->next = nullptr;
+            if (tail == nullptr) {
+                head = waiter;
+            } else {
+                tail->next = waiter;
+            }
+            tail = waiter;
+        }
+
+        Waiter* pop() {
+            Waiter* waiter = head;
+            head = waiter->next;
+            if (head == nullptr) {
+                tail = nullptr;
+            }
+            return waiter;
+        }
+    };
+
+    Scheduler& scheduler;
+    Alloc alloc;
+    size_t capacity;
+
+    std::mutex mutex;
+    Nodes items;
+    Nodes spare;
+    WaiterQueue consumers;
+    WaiterQueue producers;
+    bool closed = false;
+
+    // Reads next before scheduling: a resumed waiter may be gone at once.
+    void wake(WaiterQueue woken) {
+        Waiter* waiter = woken.head;
+        while (waiter != nullptr) {
+            Waiter* next = waiter->next;
+            scheduler.schedule(waiter->handle);
+            waiter = next;
+        }
+    }
+
+    void stage(Nodes& nodes, T&& value) {
+        std::unique_lock lock(mutex);
+        if (spare.size() == 0) {
+            nodes.push_back(std::move(value));
+            return;
+        }
+        nodes.splice(nodes.cend(), spare, spare.cbegin());
+        lock.unlock();
+        *nodes.begin() = std::move(value);
+    }
+
+    bool suspend_push(Waiter& waiter, std::coroutine_handle<> handle) {
+        WaiterQueue woken;
+        {
+            std::lock_guard lock(mutex);
+            if (closed) {
+                waiter.closed = true;
+                return false;
+            }
+            if (!consumers.empty()) {
+                Waiter* consumer = consumers.pop();
+                consumer->nodes.splice(consumer->nodes.cend(), waiter.nodes);
+                woken.push(consumer);
+            } else if (items.size() < capacity) {
+                items.splice(items.cend(), waiter.nodes);
+            } else {
+                waiter.handle = handle;
+                producers.push(&waiter);
+                return true;
+            }
+        }
+        wake(woken);
+        return false;
+    }
+
+    bool suspend_pop(Waiter& waiter, std::coroutine_handle<> handle) {
+        WaiterQueue woken;
+        {
+            std::lock_guard lock(mutex);
+            if (items.size() == 0 && !closed) {
+                waiter.handle = handle;
+                consumers.push(&waiter);
+                return true;
+            }
+            if (waiter.batch) {
+                waiter.nodes.splice(waiter.nodes.cend(), items);
+            } else if (items.size() != 0) {
+                waiter.nodes.splice(waiter.nodes.cend(), items, items.cbegin());
+            }
+            // The freed slots admit waiting producers in arrival order.
+            while (!producers.empty() && items.size() < capacity) {
+                Waiter* producer = producers.pop();
+                items.splice(items.cend(), producer->nodes);
+                woken.push(producer);
+            }
+        }
+        wake(woken);
+        return false;
+    }
+
+    class PushAwaiter {
+      private:
+        Channel& channel;
+        Waiter waiter;
+
+      public:
+        PushAwaiter(Channel& channel, T&& value)
+            : channel(channel), waiter(channel.alloc) {
+            channel.stage(waiter.nodes, std::move(value));
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return channel.suspend_push(waiter, handle);
+        }
+
+        // false if the channel was closed and the value dropped.
+        bool await_resume() {
+            if (waiter.closed) {
+                channel.recycle(waiter.nodes);
+            }
+            return !waiter.closed;
+        }
+    };
+
+    class PopAwaiter {
+      private:
+        Channel& channel;
+        Waiter waiter;
+
+      public:
+        PopAwaiter(Channel& channel)
+            : channel(channel), waiter(channel.alloc) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return channel.suspend_pop(waiter, handle);
+        }
+
+        // std::nullopt once the channel is closed and drained.
+        std::optional<T> await_resume() {
+            if (waiter.nodes.size() == 0) {
+                return std::nullopt;
+            }
+            std::optional<T> value(std::move(*waiter.nodes.begin()));
+            channel.recycle(waiter.nodes);
+            return value;
+        }
+    };
+
+    class PopAllAwaiter {
+      private:
+        Channel& channel;
+        Waiter waiter;
+
+      public:
+        PopAllAwaiter(Channel& channel)
+            : channel(channel), waiter(channel.alloc) {
+            waiter.batch = true;
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return channel.suspend_pop(waiter, handle);
+        }
+
+        // Empty once the channel is closed and drained.
+        Nodes await_resume() {
+            return std::move(waiter.nodes);
+        }
+    };
+
+  public:
+    Channel(Scheduler& scheduler, size_t capacity,
+            const Alloc& alloc = Alloc())
+        : scheduler(scheduler),
+          alloc(alloc),
+          capacity(capacity),
+          items(alloc),
+          spare(alloc) {
+        if (capacity == 0) {
+            throw std::invalid_argument("channel capacity must be positive");
+        }
+    }
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    PushAwaiter push(T value) {
+        return PushAwaiter(*this, std::move(value));
+    }
+
+    PopAwaiter pop() {
+        return PopAwaiter(*this);
+    }
+
+    // Takes everything buffered in one splice, waiting only while the
+    // channel is empty.
+    PopAllAwaiter pop_all() {
+        return PopAllAwaiter(*this);
+    }
+
+    // Gives consumed nodes back for reuse by later pushes. The spare list
+    // never grows past the most nodes that were in flight at once.
+    void recycle(Nodes& nodes) {
+        std::lock_guard lock(mutex);
+        spare.splice(spare.cend(), nodes);
+    }
+
+    // Wakes every waiter: pending pushes fail, pops still receive what is
+    // buffered and then std::nullopt.
+    void close() {
+        WaiterQueue woken;
+        {
+            std::lock_guard lock(mutex);
+            closed = true;
+            while (!producers.empty()) {
+                Waiter* producer = producers.pop();
+                producer->closed = true;
+                woken.push(producer);
+            }
+            while (!consumers.empty()) {
+                woken.push(consumers.pop());
+            }
+        }
+        wake(woken);
+    }
+
+    size_t size() {
+        std::lock_guard lock(mutex);
+        return items.size();
+    }
+};
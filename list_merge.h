@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "list.h"
+
+namespace list_detail {
+
+// Tournament tree of losers over the fronts of k lists. tree[0] holds the
+// list whose front is smallest, every internal node the loser of the match
+// played there; leaf i sits at position k + i. After the winner gives up its
+// front only the matches on its path to the root are replayed, one
+// comparison per level. Ties go to the lower list index, which keeps the
+// merge stable.
+template <typename T, typename Alloc, typename Compare>
+class LoserTree {
+  private:
+    std::span<List<T, Alloc>> lists;
+    Compare& comp;
+    std::vector<size_t> tree;
+
+    bool beats(size_t a, size_t b) const {
+        if (lists[a].size() == 0) {
+            return false;
+        }
+        if (lists[b].size() == 0) {
+            return true;
+        }
+        const T& front_a = *lists[a].cbegin();
+        const T& front_b = *lists[b].cbegin();
+        if (comp(front_a, front_b)) {
+            return true;
+        }
+        return !comp(front_b, front_a) && a < b;
+    }
+
+    size_t build(size_t node) {
+        if (node >= lists.size()) {
+            return node - lists.size();
+        }
+        size_t left = build(2 * node);
+        size_t right = build(2 * node + 1);
+        if (beats(left, right)) {
+            tree[node] = right;
+            return left;
+        }
+        tree[node] = left;
+        return right;
+    }
+
+  public:
+    LoserTree(std::span<List<T, Alloc>> lists, Compare& comp)
+        : lists(lists), comp(comp), tree(lists.size()) {
+        tree[0] = build(1);
+    }
+
+    // The list with the smallest front; empty once every list is.
+    size_t winner() const {
+        return tree[0];
+    }
+
+    void replay() {
+        size_t winner = tree[0];
+        for (size_t node = (winner + lists.size()) / 2; node > 0; node /= 2) {
+            if (beats(tree[node], winner)) {
+                std::swap(tree[node], winner);
+            }
+        }
+        tree[0] = winner;
+    }
+};
+
+}  // namespace list_detail
+
+// Merges the sorted lists into one sorted list and leaves them empty. Nodes
+// are relinked into the result one splice at a time, so when a list's
+// allocator compares equal to the first list's, none of its elements is
+// allocated, copied or moved; only lists from other arenas have their
+// elements moved into new nodes. The merge is stable across lists too:
+// equal elements keep the order of the lists they came from.
+//
+// With no lists at all the result uses a default-constructed allocator, or
+// std::invalid_argument is thrown if there is none. If comp throws, every
+// element is still in lists[0] or its own list.
+template <typename T, typename Alloc, typename Compare = std::less<>>
+List<T, Alloc> merge_k(std::span<List<T, Alloc>> lists,
+                       Compare comp = Compare()) {
+    if (lists.empty()) {
+        if constexpr (std::is_default_constructible_v<Alloc>) {
+            return List<T, Alloc>();
+        } else {
+            throw std::invalid_argument("merge_k: no list to take an allocator from");
+        }
+    }
+    List<T, Alloc> result(lists[0].get_allocator());
+    std::vector<bool> relink(lists.size());
+    size_t total = 0;
+    for (size_t i = 0; i < lists.size(); ++i) {
+        relink[i] = lists[i].get_allocator() == result.get_allocator();
+        total += lists[i].size();
+    }
+
+    try {
+        list_detail::LoserTree<T, Alloc, Compare> tree(lists, comp);
+        for (size_t left = total; left > 0; --left) {
+            List<T, Alloc>& source = lists[tree.winner()];
+            if (relink[tree.winner()]) {
+                result.splice(result.cend(), source, source.cbegin());
+            } else {
+                result.push_back(std::move(*source.begin()));
+                source.pop_front();
+            }
+            tree.replay();
+        }
+    } catch (...) {
+        lists[0].splice(lists[0].cbegin(), result);
+        throw;
+    }
+    return result;
+}
+
+// merge_k as a tree of merges: up to threads groups of adjacent lists are
+// merged concurrently, and their results are merged once more. Relinking
+// allocates nothing, so this is safe for an arena allocator as well; with
+// mixed allocators, where nodes would have to be allocated from several
+// threads, it falls back to a single merge_k.
+template <typename T, typename Alloc, typename Compare = std::less<>>
+List<T, Alloc> merge_k_parallel(std::span<List<T, Alloc>> lists,
+                                size_t threads, Compare comp = Compare()) {
+    bool same_allocator = true;
+    for (const List<T, Alloc>& lst : lists) {
+        same_allocator = same_allocator &&
+                         lst.get_allocator() == lists[0].get_allocator();
+    }
+    size_t groups = std::min(threads, lists.size() / 2);
+    if (!same_allocator || groups < 2) {
+        return merge_k(lists, comp);
+    }
+
+    std::vector<List<T, Alloc>> partial;
+    partial.reserve(groups);
+    for (size_t g = 0; g < groups; ++g) {
+        partial.emplace_back(lists[0].get_allocator());
+    }
+    // On failure the nodes already merged go back to the caller's lists.
+    auto give_back = [&] {
+        for (List<T, Alloc>& merged : partial) {
+            lists[0].splice(lists[0].cbegin(), merged);
+        }
+    };
+    std::vector<std::exception_ptr> errors(groups);
+    std::vector<std::thread> workers;
+    workers.reserve(groups);
+    try {
+        for (size_t g = 0; g < groups; ++g) {
+            workers.emplace_back([&, g, comp] {
+                size_t from = g * lists.size() / groups;
+                size_t to = (g + 1) * lists.size() / groups;
+                try {
+                    partial[g] = merge_k(lists.subspan(from, to - from), comp);
+                } catch (...) {
+                    errors[g] = std::current_exception();
+                }
+            });
+        }
+    } catch (...) {
+        // A thread failed to start; the ones running must still be joined.
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        give_back();
+        throw;
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    for (size_t g = 0; g < groups; ++g) {
+        if (errors[g]) {
+            give_back();
+            std::rethrow_exception(errors[g]);
+        }
+    }
+    return merge_k(std::span(partial), comp);
+}
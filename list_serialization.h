@@ -0,0 +1,141 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "list.h"
+
+// Binary dump of a List: a fixed header followed by the elements laid out
+// contiguously in native byte order.
+struct ListDumpHeader {
+    uint32_t magic = 0;
+    uint32_t elem_size = 0;
+    uint64_t count = 0;
+};
+
+constexpr uint32_t kListDumpMagic = 0x5453494C;  // "LIST"
+constexpr size_t kListDumpChunkBytes = 64 * 1024;
+
+template <typename T>
+constexpr size_t kListDumpChunk =
+    sizeof(T) < kListDumpChunkBytes ? kListDumpChunkBytes / sizeof(T) : 1;
+
+static_assert(sizeof(ListDumpHeader) == 16);
+
+template <typename T>
+ListDumpHeader read_list_header(std::istream& in) {
+    ListDumpHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("list dump: truncated header");
+    }
+    if (header.magic != kListDumpMagic || header.elem_size != sizeof(T)) {
+        throw std::runtime_error("list dump: header does not match T");
+    }
+    return header;
+}
+
+// Streams the elements through a fixed-size buffer, so the dump never needs
+// a second in-memory copy of the list.
+template <typename T, typename Alloc>
+void write_list(std::ostream& out, const List<T, Alloc>& lst) {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    ListDumpHeader header{kListDumpMagic, sizeof(T), lst.size()};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    alignas(T) char chunk[kListDumpChunk<T> * sizeof(T)];
+    size_t filled = 0;
+    for (const T& el : lst) {
+        std::memcpy(chunk + filled * sizeof(T), &el, sizeof(T));
+        if (++filled == kListDumpChunk<T>) {
+            out.write(chunk, sizeof(chunk));
+            filled = 0;
+        }
+    }
+    out.write(chunk, static_cast<std::streamsize>(filled * sizeof(T)));
+    if (!out) {
+        throw std::runtime_error("list dump: write failed");
+    }
+}
+
+// Hands the dump to f chunk by chunk as std::span<const T>, so lists larger
+// than memory can be processed without materializing them.
+template <typename T, typename F>
+void read_list_chunks(std::istream& in, F&& f) {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    uint64_t left = read_list_header<T>(in).count;
+    alignas(T) char chunk[kListDumpChunk<T> * sizeof(T)];
+    while (left != 0) {
+        size_t count = left < kListDumpChunk<T> ? left : kListDumpChunk<T>;
+        if (!in.read(chunk, static_cast<std::streamsize>(count * sizeof(T)))) {
+            throw std::runtime_error("list dump: truncated elements");
+        }
+        f(std::span<const T>(reinterpret_cast<const T*>(chunk), count));
+        left -= count;
+    }
+}
+
+// Appends the dump to lst, one chunk at a time: the chunk's values are
+// copied into fresh nodes that are chained in one pass and then spliced in.
+// With a StackAllocator each chunk's nodes come from a single allocation,
+// back to back in the arena. If the stream turns out to be truncated, the
+// chunks read before that stay appended to lst.
+template <typename T, typename Alloc>
+void read_list(std::istream& in, List<T, Alloc>& lst) {
+    read_list_chunks<T>(in, [&lst](std::span<const T> chunk) {
+        lst.insert(lst.cend(), chunk.begin(), chunk.end());
+    });
+}
+
+// Read-only view over a dump that is already in memory, e.g. an mmap-ed
+// file: elements are exposed in place without copying.
+template <typename T>
+class ListDumpView {
+  private:
+    const T* first = nullptr;
+    size_t count = 0;
+
+  public:
+    ListDumpView(std::span<const char> bytes) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        static_assert(alignof(T) <= sizeof(ListDumpHeader));
+
+        ListDumpHeader header;
+        if (bytes.size() < sizeof(header)) {
+            throw std::runtime_error("list dump: truncated header");
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (header.magic != kListDumpMagic || header.elem_size != sizeof(T)) {
+            throw std::runtime_error("list dump: header does not match T");
+        }
+        if ((bytes.size() - sizeof(header)) / sizeof(T) < header.count) {
+            throw std::runtime_error("list dump: truncated elements");
+        }
+        if (reinterpret_cast<uintptr_t>(bytes.data()) % alignof(T) != 0) {
+            throw std::runtime_error("list dump: misaligned buffer");
+        }
+        first = reinterpret_cast<const T*>(bytes.data() + sizeof(header));
+        count = header.count;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    const T* begin() const {
+        return first;
+    }
+
+    const T* end() const {
+        return first + count;
+    }
+
+    const T& operator[](size_t i) const {
+        return first[i];
+    }
+};
@@ -0,0 +1,268 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Allocator and node plumbing shared by List and ForwardList, so that the
+// two handle allocators, copies and moves the same way.
+
+namespace list_detail {
+
+// Links of a List node; an unlinked one points at itself.
+struct ListLinks {
+    ListLinks* next = this;  // or nullptr
+    ListLinks* prev = this;  // or nullptr
+};
+
+// Link of a ForwardList node; the last node points at nothing.
+struct ForwardLinks {
+    ForwardLinks* next = nullptr;
+};
+
+// Links come first and the value right after them, so an empty T takes no
+// space at all.
+template <typename T, typename Links>
+struct ValueNode : Links {
+    [[no_unique_address]] T val;
+    constexpr ValueNode() noexcept(std::is_nothrow_default_constructible_v<T>) = default;
+    template <typename... Args>
+    constexpr ValueNode(std::in_place_t /*unused*/, Args&&... args) noexcept(
+        std::is_nothrow_constructible_v<T, Args&&...>)
+        : val(std::forward<Args>(args)...) {}
+    // Leaves a trivially default constructible val uninitialized for the
+    // caller to memcpy into.
+    constexpr explicit ValueNode(std::nullptr_t /*unused*/) noexcept {}
+};
+
+template <typename Derived, typename T, typename Alloc, typename Links>
+class NodeContainer;
+
+// Iterator over linked nodes; bidirectional when the links have prev.
+template <typename T, typename Links, bool IsConst>
+class NodeIterator {
+  private:
+    template <typename, typename, typename, typename>
+    friend class NodeContainer;
+
+    using Node = ValueNode<T, Links>;
+    using NodePtr = std::conditional_t<IsConst, const Links*, Links*>;
+    using RealPtr = std::conditional_t<IsConst, const Node*, Node*>;
+    static constexpr bool kBidirectional = requires(Links& links) { links.prev; };
+
+    NodePtr node_ptr = nullptr;
+
+  public:
+    using value_type = T;
+    using reference = std::conditional_t<IsConst, const T&, T&>;
+    using pointer = std::conditional_t<IsConst, const T*, T*>;
+    using difference_type = ptrdiff_t;
+    using iterator_category =
+        std::conditional_t<kBidirectional, std::bidirectional_iterator_tag,
+                           std::forward_iterator_tag>;
+
+    NodeIterator() = default;
+    constexpr NodeIterator(NodePtr node_ptr)
+        : node_ptr(node_ptr) {}
+
+    constexpr operator NodeIterator<T, Links, true>() const {
+        return NodeIterator<T, Links, true>(node_ptr);
+    }
+
+    constexpr NodeIterator& operator++() {
+        node_ptr = node_ptr->next;
+        return *this;
+    }
+
+    constexpr NodeIterator operator++(int) {
+        auto copy = *this;
+        node_ptr = node_ptr->next;
+        return copy;
+    }
+
+    constexpr NodeIterator& operator--()
+        requires kBidirectional
+    {
+        node_ptr = node_ptr->prev;
+        return *this;
+    }
+
+    constexpr NodeIterator operator--(int)
+        requires kBidirectional
+    {
+        auto copy = *this;
+        node_ptr = node_ptr->prev;
+        return copy;
+    }
+
+    constexpr bool operator==(const NodeIterator&) const = default;
+
+    constexpr reference operator*() const {
+        RealPtr real = static_cast<RealPtr>(node_ptr);
+        return real->val;
+    }
+
+    constexpr pointer operator->() const {
+        RealPtr real = static_cast<RealPtr>(node_ptr);
+        return &(real->val);
+    }
+};
+
+// Base of a linked container Derived, which must befriend it and provide
+//   clear(), push_back(), emplace_back() and swap() as usual;
+//   take_links(another): adopt the nodes of a non-empty another while this
+//     one is empty, leaving another's links empty; sz is handled here;
+//   truncate(n): erase everything after the first n elements;
+//   splice_back(another): move all nodes of another to the end.
+template <typename Derived, typename T, typename Alloc, typename Links>
+class NodeContainer {
+  protected:
+    using BaseNode = Links;
+    using Node = ValueNode<T, Links>;
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+    using ConstIterator = NodeIterator<T, Links, true>;
+
+    static_assert(!std::is_empty_v<T> || sizeof(Node) == sizeof(BaseNode),
+                  "empty T must not grow the node");
+
+    // Destruction can be skipped entirely when T has a trivial destructor and
+    // the allocator does not hook destroy().
+    static constexpr bool kTrivialDestroy =
+        std::is_trivially_destructible_v<T> &&
+        !requires(NodeAlloc& alloc, Node* node) { alloc.destroy(node); };
+
+    [[no_unique_address]] NodeAlloc allocator;
+    size_t sz = 0;
+
+    constexpr NodeContainer()
+        : allocator{} {}
+    constexpr NodeContainer(const NodeAlloc& external_allocator)
+        : allocator(external_allocator) {}
+
+    constexpr Derived& self() {
+        return static_cast<Derived&>(*this);
+    }
+
+    // Positions come in as const_iterator, but every member taking one is
+    // non-const, so the node is really ours to modify.
+    static constexpr BaseNode* unconst(ConstIterator it) {
+        return const_cast<BaseNode*>(it.node_ptr);  // NOLINT
+    }
+
+    template <typename... Args>
+    constexpr Node* make_node(Args&&... args) {
+        Node* node = NodeAllocTraits::allocate(allocator, 1);
+        try {
+            NodeAllocTraits::construct(allocator, node, std::forward<Args>(args)...);
+        } catch (...) {
+            NodeAllocTraits::deallocate(allocator, node, 1);
+            throw;
+        }
+        return node;
+    }
+
+    constexpr void destroy_node(Node* node) {
+        if constexpr (!kTrivialDestroy) {
+            NodeAllocTraits::destroy(allocator, node);
+        }
+        NodeAllocTraits::deallocate(allocator, node, 1);
+    }
+
+    // Fills an empty container from [first, last); on exception it is left
+    // empty again.
+    template <typename InputIt, typename Sentinel>
+    constexpr void construct_from(InputIt first, Sentinel last) {
+        try {
+            for (; first != last; ++first) {
+                self().push_back(*first);
+            }
+        } catch (...) {
+            self().clear();
+            throw;
+        }
+    }
+
+    // Fills an empty container with copies of another's elements, with the
+    // same guarantee as construct_from.
+    constexpr void copy_from(const Derived& another) {
+        self().construct_from(another.cbegin(), another.cend());
+    }
+
+    // Takes over the nodes of another; the caller guarantees that our
+    // allocator can free them and that this container is empty.
+    constexpr void steal(Derived& another) noexcept {
+        if (another.sz == 0) {
+            return;
+        }
+        self().take_links(another);
+        sz = std::exchange(another.sz, 0);
+    }
+
+    // Moves the elements of another into our own nodes, reusing the ones we
+    // already have, and empties another.
+    constexpr void move_elements_from(Derived& another) {
+        auto src = another.begin();
+        size_t reused = 0;
+        for (auto dst = self().begin(); src != another.end() && dst != self().end();
+             ++src, ++dst, ++reused) {
+            *dst = std::move(*src);
+        }
+        self().truncate(reused);
+        Derived rest(allocator);
+        for (; src != another.end(); ++src) {
+            rest.emplace_back(std::move(*src));
+        }
+        self().splice_back(rest);
+        another.clear();
+    }
+
+    constexpr void copy_assign(const Derived& another) {
+        Derived copy(allocator);
+        copy.copy_from(another);
+        self().swap(copy);
+        if (NodeAllocTraits::propagate_on_container_copy_assignment::value) {
+            allocator = another.allocator;
+        }
+    }
+
+    static constexpr bool kNothrowMoveAssign =
+        NodeAllocTraits::propagate_on_container_move_assignment::value ||
+        NodeAllocTraits::is_always_equal::value;
+
+    // Steals the nodes in O(1) when the allocator propagates or both
+    // allocators can free each other's nodes. Otherwise the nodes of another
+    // belong to a different arena, so elements are moved one by one into our
+    // own nodes.
+    constexpr void move_assign(Derived& another) noexcept(kNothrowMoveAssign) {
+        if (&self() == &another) {
+            return;
+        }
+        if constexpr (NodeAllocTraits::propagate_on_container_move_assignment::value) {
+            self().clear();
+            allocator = another.allocator;
+            steal(another);
+        } else if constexpr (NodeAllocTraits::is_always_equal::value) {
+            self().clear();
+            steal(another);
+        } else if (allocator == another.allocator) {
+            self().clear();
+            steal(another);
+        } else {
+            move_elements_from(another);
+        }
+    }
+
+  public:
+    constexpr NodeAlloc get_allocator() const {
+        return allocator;
+    }
+
+    constexpr size_t size() const {
+        return sz;
+    }
+};
+
+}  // namespace list_detail
@@ -0,0 +1,153 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware performance counters for the calling thread, read through Linux
+// perf_event_open. Every event is opened on its own rather than as a group,
+// so one event the PMU (or a VM) does not support only drops that column.
+// When perf is unavailable altogether, e.g. perf_event_paranoid forbids it,
+// every counter reports as unavailable and callers keep only wall time.
+class PerfCounters {
+  public:
+    struct Event {
+        const char* name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+    struct Reading {
+        const char* name;
+        bool available;
+        double value;
+    };
+
+  private:
+    struct Counter {
+        Event event;
+        int fd = -1;
+    };
+
+    std::vector<Counter> counters;
+
+#if defined(__linux__)
+    static constexpr uint64_t cache_event(uint64_t cache, uint64_t op,
+                                          uint64_t result) {
+        return cache | (op << 8) | (result << 16);
+    }
+
+    static int open_event(const Event& event) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format =
+            PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(
+            syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+
+  public:
+    static std::vector<Event> default_events() {
+#if defined(__linux__)
+        return {
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instr", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"L1d-miss", PERF_TYPE_HW_CACHE,
+             cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                         PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {"LLC-miss", PERF_TYPE_HW_CACHE,
+             cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ,
+                         PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {"dTLB-miss", PERF_TYPE_HW_CACHE,
+             cache_event(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                         PERF_COUNT_HW_CACHE_RESULT_MISS)},
+            {"br-miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+#else
+        return {};
+#endif
+    }
+
+    PerfCounters(const std::vector<Event>& events = default_events()) {
+        for (const Event& event : events) {
+            Counter counter{event};
+#if defined(__linux__)
+            counter.fd = open_event(event);
+#endif
+            counters.push_back(counter);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (const Counter& counter : counters) {
+            if (counter.fd >= 0) {
+                close(counter.fd);
+            }
+        }
+#endif
+    }
+
+    bool any_available() const {
+        for (const Counter& counter : counters) {
+            if (counter.fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void start() {
+#if defined(__linux__)
+        for (const Counter& counter : counters) {
+            if (counter.fd >= 0) {
+                ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    // Stops counting and returns every counter divided by per, e.g. the
+    // number of elements an operation touched. Counts are scaled up when
+    // the kernel had to multiplex the PMU between events.
+    std::vector<Reading> stop(double per = 1.0) {
+        std::vector<Reading> readings;
+        for (const Counter& counter : counters) {
+            Reading reading{counter.event.name, false, 0.0};
+#if defined(__linux__)
+            if (counter.fd >= 0) {
+                ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+                uint64_t values[3] = {};  // value, enabled, running
+                if (read(counter.fd, values, sizeof(values)) ==
+                        static_cast<ssize_t>(sizeof(values)) &&
+                    values[2] != 0) {
+                    double scale = static_cast<double>(values[1]) /
+                                   static_cast<double>(values[2]);
+                    reading.available = true;
+                    reading.value = static_cast<double>(values[0]) * scale / per;
+                }
+            }
+#endif
+            readings.push_back(reading);
+        }
+        return readings;
+    }
+};
@@ -0,0 +1,350 @@
+#pragma once
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+// Doubly linked list living in a file-backed mmap region. Links are byte
+// offsets from the start of the region instead of BaseNode* pointers, so
+// the file stays valid when it is mapped again at another address and a
+// process can reopen a list without rebuilding it.
+//
+// Like StackStorage, the region is one contiguous buffer carved by a bump
+// pointer; erased nodes go to a free list and are reused first.
+template <typename T>
+class PersistentList {
+  private:
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "elements are stored as raw bytes in the file");
+
+    using Offset = uint64_t;
+
+    struct BaseNode {
+        Offset next = 0;
+        Offset prev = 0;
+    };
+    struct Node : BaseNode {
+        T val;
+    };
+
+    struct Header {
+        uint64_t magic = 0;
+        uint64_t elem_size = 0;
+        uint64_t sz = 0;
+        uint64_t top = 0;
+        Offset free_head = 0;
+        BaseNode fakeNode;
+    };
+
+    static constexpr uint64_t kMagic = 0x5453494C54524550;  // "PERTLIST"
+    static constexpr Offset kFake = offsetof(Header, fakeNode);
+    static constexpr size_t kInitialBytes = 4096;
+    static constexpr size_t kFirstNode =
+        (sizeof(Header) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+
+    int fd = -1;
+    char* base = nullptr;
+    size_t mapped = 0;
+
+    [[noreturn]] static void fail(const char* what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    Header& header() const {
+        return *reinterpret_cast<Header*>(base);
+    }
+
+    BaseNode& at(Offset offset) const {
+        return *reinterpret_cast<BaseNode*>(base + offset);
+    }
+
+    void grow(size_t bytes) {
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            fail("persistent list: ftruncate");
+        }
+        void* remapped = mremap(base, mapped, bytes, MREMAP_MAYMOVE);  // NOLINT
+        if (remapped == MAP_FAILED) {
+            fail("persistent list: mremap");
+        }
+        base = static_cast<char*>(remapped);
+        mapped = bytes;
+    }
+
+    Offset allocate_node() {
+        Header& head = header();
+        if (head.free_head != 0) {
+            Offset node = head.free_head;
+            head.free_head = at(node).next;
+            return node;
+        }
+        if (head.top + sizeof(Node) > mapped) {
+            size_t bytes = mapped * 2;
+            while (head.top + sizeof(Node) > bytes) {
+                bytes *= 2;
+            }
+            grow(bytes);
+        }
+        Offset node = header().top;
+        header().top += sizeof(Node);
+        return node;
+    }
+
+    // Nodes are only ever carved at kFirstNode + k * sizeof(Node) below top.
+    bool is_node(Offset offset) const {
+        const Header& head = header();
+        return offset >= kFirstNode && offset < head.top &&
+               (offset - kFirstNode) % sizeof(Node) == 0;
+    }
+
+    // Checks a reopened file before any of it is used, so that a truncated
+    // or corrupt file cannot send us outside the region: the header, then
+    // every link of the list, which must run back to the sentinel in exactly
+    // sz steps with matching prev links, and the free list, which must hold
+    // every other node carved below top. Costs one walk over the file.
+    bool consistent() const {
+        const Header& head = header();
+        if (head.top < kFirstNode || head.top > mapped ||
+            (head.top - kFirstNode) % sizeof(Node) != 0) {
+            return false;
+        }
+        size_t slots = (head.top - kFirstNode) / sizeof(Node);
+        if (head.sz > slots) {
+            return false;
+        }
+        auto link_ok = [this](Offset offset) {
+            return offset == kFake || is_node(offset);
+        };
+        if (!link_ok(head.fakeNode.next) || !link_ok(head.fakeNode.prev)) {
+            return false;
+        }
+        Offset prev = kFake;
+        Offset node = head.fakeNode.next;
+        for (size_t seen = 0; node != kFake; ++seen) {
+            if (seen == head.sz || at(node).prev != prev || !link_ok(at(node).next)) {
+                return false;
+            }
+            prev = node;
+            node = at(node).next;
+        }
+        if (head.fakeNode.prev != prev) {
+            return false;
+        }
+        size_t spare = 0;
+        for (Offset slot = head.free_head; slot != 0; slot = at(slot).next) {
+            if (!is_node(slot) || head.sz + spare == slots) {
+                return false;
+            }
+            ++spare;
+        }
+        return head.sz + spare == slots;
+    }
+
+    template <bool IsConst>
+    class CommonIterator {
+      private:
+        friend PersistentList;
+        // The owner is kept instead of a raw pointer, so iterators survive
+        // the region being remapped by growth.
+        const PersistentList* owner = nullptr;
+        Offset node = 0;
+
+      public:
+        using value_type = T;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using difference_type = ptrdiff_t;
+        using iterator_category = std::bidirectional_iterator_tag;
+
+        CommonIterator() = default;
+        CommonIterator(const PersistentList* owner, Offset node)
+            : owner(owner), node(node) {}
+
+        operator CommonIterator<true>() const {
+            return CommonIterator<true>(owner, node);
+        }
+
+        CommonIterator& operator++() {
+            node = owner->at(node).next;
+            return *this;
+        }
+
+        CommonIterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        CommonIterator& operator--() {
+            node = owner->at(node).prev;
+            return *this;
+        }
+
+        CommonIterator operator--(int) {
+            auto copy = *this;
+            --*this;
+            return copy;
+        }
+
+        bool operator==(const CommonIterator&) const = default;
+
+        reference operator*() const {
+            return static_cast<Node&>(owner->at(node)).val;
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+    };
+
+  public:
+    using iterator = CommonIterator<false>;
+    using const_iterator = CommonIterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    // Opens the list stored at path, creating an empty one if the file is
+    // missing or empty.
+    PersistentList(const char* path) {
+        fd = open(path, O_RDWR | O_CREAT, 0644);  // NOLINT
+        if (fd < 0) {
+            fail("persistent list: open");
+        }
+        struct stat st {};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            fail("persistent list: fstat");
+        }
+        bool fresh = st.st_size == 0;
+        mapped = fresh ? kInitialBytes : static_cast<size_t>(st.st_size);
+        if (fresh && ftruncate(fd, static_cast<off_t>(mapped)) != 0) {
+            close(fd);
+            fail("persistent list: ftruncate");
+        }
+        void* region =
+            mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (region == MAP_FAILED) {
+            close(fd);
+            fail("persistent list: mmap");
+        }
+        base = static_cast<char*>(region);
+
+        if (fresh) {
+            new (base) Header{kMagic, sizeof(T), 0, kFirstNode, 0, {kFake, kFake}};
+        } else if (mapped < sizeof(Header) || header().magic != kMagic ||
+                   header().elem_size != sizeof(T)) {
+            munmap(base, mapped);
+            close(fd);
+            throw std::runtime_error("persistent list: file does not match T");
+        } else if (!consistent()) {
+            munmap(base, mapped);
+            close(fd);
+            throw std::runtime_error("persistent list: corrupt file");
+        }
+    }
+
+    PersistentList(const PersistentList&) = delete;
+    PersistentList& operator=(const PersistentList&) = delete;
+
+    ~PersistentList() {
+        munmap(base, mapped);
+        close(fd);
+    }
+
+    // Flushes the region to the file; without it the kernel writes pages
+    // back on its own schedule.
+    void sync() {
+        if (msync(base, mapped, MS_SYNC) != 0) {
+            fail("persistent list: msync");
+        }
+    }
+
+    size_t size() const {
+        return header().sz;
+    }
+
+    iterator begin() {
+        return iterator(this, header().fakeNode.next);
+    }
+    const_iterator begin() const {
+        return cbegin();
+    }
+    const_iterator cbegin() const {
+        return const_iterator(this, header().fakeNode.next);
+    }
+
+    iterator end() {
+        return iterator(this, kFake);
+    }
+    const_iterator end() const {
+        return cend();
+    }
+    const_iterator cend() const {
+        return const_iterator(this, kFake);
+    }
+
+    reverse_iterator rbegin() {
+        return reverse_iterator(end());
+    }
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(cend());
+    }
+
+    reverse_iterator rend() {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(cbegin());
+    }
+
+    void push_back(const T& el) {
+        insert(cend(), el);
+    }
+    void push_front(const T& el) {
+        insert(cbegin(), el);
+    }
+    void pop_back() {
+        erase(--cend());
+    }
+    void pop_front() {
+        erase(cbegin());
+    }
+
+    void insert(const_iterator it, const T& el) {
+        T copy = el;  // el may live in the region that allocate_node remaps
+        Offset node = allocate_node();
+        new (&at(node)) Node{{it.node, at(it.node).prev}, copy};
+
+        at(at(node).prev).next = node;
+        at(it.node).prev = node;
+        ++header().sz;
+    }
+
+    void erase(const_iterator it) {
+        BaseNode& node = at(it.node);
+        at(node.prev).next = node.next;
+        at(node.next).prev = node.prev;
+
+        node.next = header().free_head;
+        header().free_head = it.node;
+        --header().sz;
+    }
+
+    // Forgets every element and rewinds the bump pointer; the file keeps its
+    // size for reuse.
+    void clear() {
+        Header& head = header();
+        head.sz = 0;
+        head.top = kFirstNode;
+        head.free_head = 0;
+        head.fakeNode = {kFake, kFake};
+    }
+};
@@ -0,0 +1,371 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Doubly linked list for read-mostly sharing between threads, RCU style:
+// readers take a Snapshot and iterate it without locks while writers keep
+// inserting and erasing.
+//
+// Every write bumps a version counter. A node remembers the version that
+// inserted it and the one that erased it, and a snapshot taken at version v
+// shows exactly the nodes alive at v, however long it is held. Erased nodes
+// stay linked until no snapshot can see them, and are freed only once no
+// snapshot taken before their unlinking is left. Readers announce their
+// version in a per-reader slot, which is the only shared state they write.
+//
+// Writers are serialized by a mutex, and the allocator is only used under
+// it, so a StackAllocator works here too.
+template <typename T, typename Alloc = std::allocator<T>>
+class SnapshotList {
+  private:
+    struct BaseNode {
+        std::atomic<BaseNode*> next = this;
+        BaseNode* prev = this;  // writers only
+    };
+    struct Node : BaseNode {
+        uint64_t born = 0;
+        std::atomic<uint64_t> died = 0;  // 0 while alive
+        uint64_t unlinked = 0;           // writers only
+        Node* reclaim_next = nullptr;    // writers only
+        T val;
+
+        template <typename... Args>
+        Node(std::in_place_t /*unused*/, Args&&... args)
+            : val(std::forward<Args>(args)...) {}
+    };
+
+    using NodeAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+    using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+
+    static constexpr size_t kCacheLine = 64;
+    static constexpr size_t kReaderSlots = 64;
+
+    // Version the reader in this slot is pinned at, 0 when the slot is free.
+    struct alignas(kCacheLine) ReaderSlot {
+        std::atomic<uint64_t> version = 0;
+    };
+
+    // FIFO of nodes waiting for reclamation, in increasing version order.
+    struct ReclaimQueue {
+        Node* head = nullptr;
+        Node* tail = nullptr;
+
+        void push(Node* node) {
+            node->reclaim_next = nullptr;
+            if (tail == nullptr) {
+                head = node;
+            } else {
+                tail->reclaim_next = node;
+            }
+            tail = node;
+        }
+
+        Node* pop() {
+            Node* node = head;
+            head = node->reclaim_next;
+            if (head == nullptr) {
+                tail = nullptr;
+            }
+            return node;
+        }
+    };
+
+    alignas(kCacheLine) std::atomic<uint64_t> version = 1;
+    mutable ReaderSlot slots[kReaderSlots];
+    // Readers take the lowest free slot, so writers only scan this many.
+    mutable std::atomic<size_t> slots_in_use = 0;
+
+    alignas(kCacheLine) std::mutex writer;
+    [[no_unique_address]] NodeAlloc allocator;
+    std::atomic<size_t> sz = 0;
+    BaseNode fakeNode;
+    ReclaimQueue erased;   // dead but still linked
+    ReclaimQueue retired;  // unlinked, maybe still under a reader
+
+    static bool visible(const BaseNode* node, uint64_t at) {
+        const Node* real = static_cast<const Node*>(node);
+        uint64_t died = real->died.load(std::memory_order_relaxed);
+        return real->born <= at && (died == 0 || at < died);
+    }
+
+    // Every snapshot still held is pinned at this version or later.
+    uint64_t oldest_reader() const {
+        uint64_t oldest = version.load();
+        size_t limit = slots_in_use.load();
+        for (size_t i = 0; i < limit; ++i) {
+            uint64_t pinned = slots[i].version.load();
+            if (pinned != 0 && pinned < oldest) {
+                oldest = pinned;
+            }
+        }
+        return oldest;
+    }
+
+    // Publishes the writes made so far as a new version.
+    uint64_t publish() {
+        uint64_t next = version.load(std::memory_order_relaxed) + 1;
+        version.store(next);
+        return next;
+    }
+
+    void free_node(Node* node) {
+        NodeAllocTraits::destroy(allocator, node);
+        NodeAllocTraits::deallocate(allocator, node, 1);
+    }
+
+    // Unlinks the erased nodes no snapshot can see any more, then frees the
+    // unlinked nodes no snapshot can be standing on. Caller holds writer.
+    void reclaim_locked() {
+        if (erased.head == nullptr && retired.head == nullptr) {
+            return;
+        }
+        uint64_t oldest = oldest_reader();
+        if (erased.head != nullptr && erased.head->died <= oldest) {
+            uint64_t stamp = version.load(std::memory_order_relaxed) + 1;
+            while (erased.head != nullptr && erased.head->died <= oldest) {
+                Node* node = erased.pop();
+                BaseNode* next = node->next.load(std::memory_order_relaxed);
+                node->prev->next.store(next, std::memory_order_release);
+                next->prev = node->prev;
+                node->unlinked = stamp;
+                retired.push(node);
+            }
+            publish();
+            oldest = oldest_reader();
+        }
+        while (retired.head != nullptr && retired.head->unlinked <= oldest) {
+            free_node(retired.pop());
+        }
+    }
+
+    template <typename... Args>
+    void emplace_locked(BaseNode* next, Args&&... args) {
+        Node* node = NodeAllocTraits::allocate(allocator, 1);
+        try {
+            NodeAllocTraits::construct(allocator, node, std::in_place,
+                                       std::forward<Args>(args)...);
+        } catch (...) {
+            NodeAllocTraits::deallocate(allocator, node, 1);
+            throw;
+        }
+        BaseNode* prev = next->prev;
+        node->born = version.load(std::memory_order_relaxed) + 1;
+        node->next.store(next, std::memory_order_relaxed);
+        node->prev = prev;
+        prev->next.store(node, std::memory_order_release);
+        next->prev = node;
+        sz.fetch_add(1, std::memory_order_relaxed);
+        publish();
+        reclaim_locked();
+    }
+
+  public:
+    class Snapshot;
+
+    // Forward iterator over the nodes alive at the snapshot's version.
+    class const_iterator {
+      private:
+        friend SnapshotList;
+        friend Snapshot;
+
+        const BaseNode* node = nullptr;
+        const BaseNode* fake = nullptr;
+        uint64_t at = 0;
+
+        const_iterator(const BaseNode* node, const BaseNode* fake, uint64_t at)
+            : node(node), fake(fake), at(at) {
+            skip_hidden();
+        }
+
+        void skip_hidden() {
+            while (node != fake && !visible(node, at)) {
+                node = node->next.load(std::memory_order_acquire);
+            }
+        }
+
+      public:
+        using value_type = T;
+        using reference = const T&;
+        using pointer = const T*;
+        using difference_type = ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        const_iterator() = default;
+
+        const_iterator& operator++() {
+            node = node->next.load(std::memory_order_acquire);
+            skip_hidden();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return node == other.node;
+        }
+
+        reference operator*() const {
+            return static_cast<const Node*>(node)->val;
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+    };
+
+    // A consistent view of the list; nothing it shows is freed while it is
+    // held. Holding it for long keeps erased nodes in memory.
+    class Snapshot {
+      private:
+        friend SnapshotList;
+
+        const SnapshotList* owner = nullptr;
+        size_t slot = 0;
+        uint64_t at = 0;
+
+        Snapshot(const SnapshotList* owner, size_t slot, uint64_t at)
+            : owner(owner), slot(slot), at(at) {}
+
+      public:
+        Snapshot(Snapshot&& another) noexcept
+            : owner(std::exchange(another.owner, nullptr)),
+              slot(another.slot),
+              at(another.at) {}
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        Snapshot& operator=(Snapshot&&) = delete;
+
+        ~Snapshot() {
+            if (owner != nullptr) {
+                owner->slots[slot].version.store(0, std::memory_order_release);
+            }
+        }
+
+        uint64_t version() const {
+            return at;
+        }
+
+        const_iterator begin() const {
+            return const_iterator(
+                owner->fakeNode.next.load(std::memory_order_acquire),
+                &owner->fakeNode, at);
+        }
+
+        const_iterator end() const {
+            return const_iterator(&owner->fakeNode, &owner->fakeNode, at);
+        }
+    };
+
+    SnapshotList(const Alloc& alloc = Alloc())
+        : allocator(alloc) {}
+
+    SnapshotList(const SnapshotList&) = delete;
+    SnapshotList& operator=(const SnapshotList&) = delete;
+
+    // No snapshot may outlive the list.
+    ~SnapshotList() {
+        BaseNode* node = fakeNode.next.load(std::memory_order_relaxed);
+        while (node != &fakeNode) {
+            BaseNode* next = node->next.load(std::memory_order_relaxed);
+            free_node(static_cast<Node*>(node));
+            node = next;
+        }
+        while (retired.head != nullptr) {
+            free_node(retired.pop());
+        }
+    }
+
+    // Pins the current version. Lock-free unless all kReaderSlots slots are
+    // taken, in which case it waits for one to be released.
+    Snapshot snapshot() const {
+        uint64_t at = version.load();
+        size_t slot = 0;
+        while (true) {
+            uint64_t expected = 0;
+            if (slots[slot].version.compare_exchange_strong(expected, at)) {
+                break;
+            }
+            if (++slot == kReaderSlots) {
+                slot = 0;
+                std::this_thread::yield();
+            }
+        }
+        size_t limit = slots_in_use.load();
+        while (limit <= slot &&
+               !slots_in_use.compare_exchange_weak(limit, slot + 1)) {
+        }
+        // A writer that scanned the slots before we took ours has already
+        // published a newer version; re-pin until the version holds still.
+        while (true) {
+            uint64_t now = version.load();
+            if (now == at) {
+                break;
+            }
+            at = now;
+            slots[slot].version.store(at);
+        }
+        return Snapshot(this, slot, at);
+    }
+
+    // Number of elements in the latest version.
+    size_t size() const {
+        return sz.load(std::memory_order_relaxed);
+    }
+
+    // Inserts before pos, which comes from a snapshot that is still held,
+    // or is its end().
+    template <typename... Args>
+    void emplace(const_iterator pos, Args&&... args) {
+        std::lock_guard lock(writer);
+        emplace_locked(const_cast<BaseNode*>(pos.node),  // NOLINT
+                       std::forward<Args>(args)...);
+    }
+
+    void insert(const_iterator pos, const T& el) {
+        emplace(pos, el);
+    }
+
+    void push_back(const T& el) {
+        std::lock_guard lock(writer);
+        emplace_locked(&fakeNode, el);
+    }
+
+    void push_front(const T& el) {
+        std::lock_guard lock(writer);
+        emplace_locked(fakeNode.next.load(std::memory_order_relaxed), el);
+    }
+
+    // Erases the element at pos, which comes from a snapshot that is still
+    // held. Returns false if another write already erased it.
+    bool erase(const_iterator pos) {
+        std::lock_guard lock(writer);
+        Node* node = static_cast<Node*>(const_cast<BaseNode*>(pos.node));  // NOLINT
+        if (node->died.load(std::memory_order_relaxed) != 0) {
+            return false;
+        }
+        node->died.store(version.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+        erased.push(node);
+        sz.fetch_sub(1, std::memory_order_relaxed);
+        publish();
+        reclaim_locked();
+        return true;
+    }
+
+    // Reclaims what the snapshots released since the last write.
+    void reclaim() {
+        std::lock_guard lock(writer);
+        reclaim_locked();
+    }
+};
@@ -1,56 +1,134 @@
 #pragma once
+#include <cstddef>
 #include <iostream>
 #include <memory>
+#include <new>
+#include <type_traits>
 
 template <size_t N>
 class StackStorage {
   public:
     size_t shift = 0;
-    char arr[N];
+    // shift is aligned relative to arr, so arr itself must be aligned for
+    // any fundamental type.
+    alignas(std::max_align_t) char arr[N];
     StackStorage(const StackStorage&) = delete;
-    StackStorage() = default;
+    constexpr StackStorage() = default;
     StackStorage& operator=(const StackStorage&) = delete;
 };
 
+// What allocate_at_least hands out: count may exceed the request.
+template <typename Pointer>
+struct AllocationResult {
+    Pointer ptr;
+    size_t count;
+};
+
 template <typename T, size_t N>
 class StackAllocator {
+  private:
+    // Offset of the first T-aligned slot at or after the top of the arena.
+    constexpr size_t aligned_top() const {
+        size_t al = alignof(T);
+        return (stack->shift + al - 1) / al * al;
+    }
+
+    constexpr bool at_top(const T* ptr, size_t n) const {
+        return reinterpret_cast<const char*>(ptr + n) == stack->arr + stack->shift;
+    }
+
   public:
     StackStorage<N>* stack;
 
     using value_type = T;
+    // deallocate() returns nothing to the arena, so any piece of a block
+    // may be handed back on its own.
+    using deallocates_piecewise = std::true_type;
 
-    StackAllocator(StackStorage<N>& pool)
+    constexpr StackAllocator(StackStorage<N>& pool)
         : stack(&pool) {}
 
     template <typename U>
-    StackAllocator(const StackAllocator<U, N>& other)
+    constexpr StackAllocator(const StackAllocator<U, N>& other)
         : stack(other.stack) {}
 
-    ~StackAllocator() {}
+    constexpr ~StackAllocator() {}
 
     template <typename U>
-    StackAllocator& operator=(const StackAllocator<U, N>& other) {
-        stack = other->stack;
+    constexpr StackAllocator& operator=(const StackAllocator<U, N>& other) {
+        stack = other.stack;
         return *this;
     }
 
-    T* allocate(size_t n) {
-        size_t al = alignof(T);
-        stack->shift = (stack->shift + al - 1) / al * al;
-        T* ans = reinterpret_cast<T*>(stack->arr + stack->shift);
-        stack->shift += n * sizeof(T);
+    // The arena cannot be carved with reinterpret_cast during constant
+    // evaluation, so there the allocator hands out transient std::allocator
+    // storage instead.
+    constexpr T* allocate(size_t n) {
+        if (std::is_constant_evaluated()) {
+            return std::allocator<T>().allocate(n);
+        }
+        size_t start = aligned_top();
+        if (start > N || n > (N - start) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        T* ans = reinterpret_cast<T*>(stack->arr + start);
+        stack->shift = start + n * sizeof(T);
         return ans;
     }
 
-    void deallocate(T* /*unused*/, size_t /*unused*/) {}
+    // Like allocate, but also hands out the padding up to the next
+    // max_align_t boundary, which the next allocation would skip anyway.
+    constexpr AllocationResult<T*> allocate_at_least(size_t n) {
+        T* ptr = allocate(n);
+        if (std::is_constant_evaluated()) {
+            return {ptr, n};
+        }
+        size_t al = alignof(std::max_align_t);
+        size_t end = (stack->shift + al - 1) / al * al;
+        size_t extra = ((end < N ? end : N) - stack->shift) / sizeof(T);
+        stack->shift += extra * sizeof(T);
+        return {ptr, n + extra};
+    }
+
+    // Grows [ptr, ptr + old_n) to new_n elements in place. This works only
+    // for the most recent allocation, which ends at the top of the arena;
+    // otherwise, or if the arena is too small, nothing changes and the
+    // result is false.
+    constexpr bool try_expand(T* ptr, size_t old_n, size_t new_n) {
+        if (std::is_constant_evaluated() || !at_top(ptr, old_n)) {
+            return false;
+        }
+        size_t start = static_cast<size_t>(reinterpret_cast<char*>(ptr) - stack->arr);
+        if (new_n > (N - start) / sizeof(T)) {
+            return false;
+        }
+        stack->shift = start + new_n * sizeof(T);
+        return true;
+    }
+
+    // Gives the tail of the most recent allocation back to the arena. For
+    // any other block nothing changes and the result is false.
+    constexpr bool shrink(T* ptr, size_t old_n, size_t new_n) {
+        if (std::is_constant_evaluated() || !at_top(ptr, old_n) || new_n > old_n) {
+            return false;
+        }
+        stack->shift -= (old_n - new_n) * sizeof(T);
+        return true;
+    }
+
+    constexpr void deallocate(T* ptr, size_t n) {
+        if (std::is_constant_evaluated()) {
+            std::allocator<T>().deallocate(ptr, n);
+        }
+    }
 
     template <typename U>
-    bool operator==(const StackAllocator<U, N>& other) {
+    constexpr bool operator==(const StackAllocator<U, N>& other) const {
         return stack == other.stack;
     }
 
     template <typename U>
-    bool operator!=(const StackAllocator<U, N>& other) {
+    constexpr bool operator!=(const StackAllocator<U, N>& other) const {
         return stack != other.stack;
     }
 
@@ -1,20 +1,42 @@
 #include <sys/resource.h>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <deque>
 #include <fstream>
+#include <initializer_list>
+#include <functional>
 #include <iostream>
 #include <list>
 #include <memory>
+#include <new>
+#include <numeric>
+#include <optional>
+#include <ranges>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "concurrent_list.h"
+#include "forward_list.h"
 #include "list.h"
+#include "list_algorithms.h"
+#include "list_channel.h"
+#include "list_merge.h"
+#include "list_serialization.h"
+#include "persistent_list.h"
+#include "snapshot_list.h"
 #include "stack_allocator.h"
+#include "vector.h"
 
 constexpr size_t STORAGE_SIZE = 200'000'000;
 StackStorage<STORAGE_SIZE> STATIC_STORAGE;  // NOLINT
@@ -210,6 +232,1164 @@ void TestAccountant(Alloc alloc = Alloc()) {
     assert(Accountant::dtor_calls == 13);
 }
 
+struct Empty {};
+
+template <typename Alloc = std::allocator<Accountant>>
+void TestClear(Alloc alloc = Alloc()) {
+    Accountant::reset();
+    {
+        List<Accountant, Alloc> lst(7, alloc);
+        lst.clear();
+        assert(lst.size() == 0);
+        assert(lst.begin() == lst.end());
+        assert(Accountant::dtor_calls == 7);
+
+        Accountant one;
+        lst.push_back(one);
+        assert(lst.size() == 1);
+    }
+    assert(Accountant::ctor_calls == Accountant::dtor_calls);
+
+    using EmptyAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<Empty>;
+    List<Empty, EmptyAlloc> empties(3, EmptyAlloc(alloc));
+    assert(empties.size() == 3);
+    empties.clear();
+    assert(empties.size() == 0);
+}
+
+template <typename Alloc = std::allocator<int>>
+constexpr int ConstexprListSum(Alloc alloc = Alloc()) {
+    List<int, Alloc> lst(alloc);
+    for (int i = 1; i <= 4; ++i) {
+        lst.push_back(i);
+    }
+    lst.push_front(10);
+    lst.pop_back();
+
+    List<int, Alloc> copy = lst;
+    copy.erase(copy.cbegin());
+
+    int sum = 0;
+    for (int x : lst) {
+        sum += x;
+    }
+    for (auto it = copy.rbegin(); it != copy.rend(); ++it) {
+        sum += *it;
+    }
+    return sum;  // (10 + 1 + 2 + 3) + (1 + 2 + 3)
+}
+
+constexpr int ConstexprStackListSum() {
+    StackStorage<256> storage;
+    StackAllocator<int, 256> alloc(storage);
+    return ConstexprListSum(alloc);
+}
+
+constexpr std::array<int, 5> kConstexprTable = [] {
+    List<int> squares;
+    for (int i = 0; i < 5; ++i) {
+        squares.push_front(i * i);
+    }
+    std::array<int, 5> table{};
+    std::copy(squares.begin(), squares.end(), table.begin());
+    return table;
+}();
+
+void TestConstexpr() {
+    static_assert(ConstexprListSum() == 22);
+    static_assert(ConstexprStackListSum() == 22);
+    static_assert(kConstexprTable[0] == 16 && kConstexprTable[4] == 0);
+
+    // The same code keeps working at runtime, where the arena is used.
+    StackStorage<256> storage;
+    StackAllocator<int, 256> alloc(storage);
+    assert(ConstexprListSum(alloc) == 22);
+    assert(storage.shift != 0);
+}
+
+// Trivially copyable, but with no default constructor to build nodes with.
+struct NoDefault {
+    explicit NoDefault(int value)
+        : value(value) {}
+    int value;
+};
+
+template <typename Alloc = std::allocator<int>>
+void TestSerialization(Alloc alloc = Alloc()) {
+    List<int, Alloc> lst(alloc);
+    for (int i = 0; i < 10'000; ++i) {
+        lst.push_back(i * 3);
+    }
+
+    std::stringstream stream;
+    write_list(stream, lst);
+    std::string bytes = stream.str();
+    assert(bytes.size() == sizeof(ListDumpHeader) + 10'000 * sizeof(int));
+
+    List<int, Alloc> loaded(alloc);
+    loaded.push_back(-1);
+    read_list(stream, loaded);
+    assert(loaded.size() == 10'001);
+    loaded.pop_front();
+    assert(std::equal(loaded.begin(), loaded.end(), lst.begin(), lst.end()));
+    if constexpr (!std::is_same_v<Alloc, std::allocator<int>>) {
+        // One chunk, one allocation: the nodes sit at a constant stride.
+        auto stride = reinterpret_cast<const char*>(&*std::next(loaded.begin())) -
+                      reinterpret_cast<const char*>(&*loaded.begin());
+        for (auto it = loaded.begin(); std::next(it) != loaded.end(); ++it) {
+            assert(reinterpret_cast<const char*>(&*std::next(it)) -
+                       reinterpret_cast<const char*>(&*it) ==
+                   stride);
+        }
+    }
+
+    std::vector<char> buffer(bytes.begin(), bytes.end());
+    ListDumpView<int> view(buffer);
+    assert(view.size() == 10'000);
+    assert(view[9'999] == 29'997);
+    assert(std::equal(view.begin(), view.end(), lst.begin(), lst.end()));
+
+    std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+    bool thrown = false;
+    try {
+        read_list(truncated, loaded);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && loaded.size() == 10'000);
+
+    // Chunks read before the truncation stay appended.
+    {
+        List<int> big(kListDumpChunk<int> + 5, 1);
+        std::stringstream big_stream;
+        write_list(big_stream, big);
+        std::string big_bytes = big_stream.str();
+        std::istringstream cut(big_bytes.substr(0, big_bytes.size() - 1));
+        List<int> partial;
+        thrown = false;
+        try {
+            read_list(cut, partial);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && partial.size() == kListDumpChunk<int>);
+    }
+
+    {
+        using NoDefaultAlloc =
+            typename std::allocator_traits<Alloc>::template rebind_alloc<NoDefault>;
+        List<NoDefault, NoDefaultAlloc> values(alloc);
+        for (int i = 0; i < 100; ++i) {
+            values.emplace_back(i);
+        }
+        std::stringstream values_stream;
+        write_list(values_stream, values);
+        List<NoDefault, NoDefaultAlloc> values_loaded(alloc);
+        read_list(values_stream, values_loaded);
+        assert(values_loaded.size() == 100);
+        assert(values_loaded.begin()->value == 0 && values_loaded.rbegin()->value == 99);
+    }
+
+    std::istringstream wrong_type(bytes);
+    thrown = false;
+    try {
+        List<double> doubles;
+        read_list(wrong_type, doubles);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void TestPersistentList() {
+    std::string path =
+        "/tmp/persistent_list_test_" + std::to_string(getpid()) + ".bin";
+    std::remove(path.c_str());
+
+    {
+        PersistentList<int64_t> lst(path.c_str());
+        assert(lst.size() == 0);
+        lst.push_back(0);
+        auto first = lst.cbegin();
+        for (int i = 1; i < 10'000; ++i) {
+            lst.push_back(i);
+        }
+        lst.push_front(-1);
+        // Growth remapped the region, iterators must still work.
+        assert(*first == 0);
+        lst.erase(first);
+        for (int i = 0; i < 5'000; ++i) {
+            lst.pop_back();
+        }
+        lst.push_back(42);  // reuses an erased node
+        lst.sync();
+    }
+    {
+        PersistentList<int64_t> lst(path.c_str());
+        assert(lst.size() == 5'001);
+        assert(*lst.begin() == -1);
+        assert(*std::next(lst.begin()) == 1);
+        assert(*lst.rbegin() == 42);
+        assert(*std::next(lst.rbegin()) == 4'999);
+
+        int64_t sum = 0;
+        for (int64_t x : lst) {
+            sum += x;
+        }
+        assert(sum == -1 + int64_t{4'999} * 5'000 / 2 + 42);
+        lst.clear();
+        assert(lst.begin() == lst.end());
+    }
+
+    bool thrown = false;
+    try {
+        PersistentList<int> wrong_type(path.c_str());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::remove(path.c_str());
+
+    // A node bigger than the region has to double it more than once.
+    struct Page {
+        char bytes[10'000];
+    };
+    {
+        PersistentList<Page> pages(path.c_str());
+        Page page{};
+        for (int i = 0; i < 3; ++i) {
+            page.bytes[9'999] = static_cast<char>(i);
+            pages.push_back(page);
+        }
+    }
+    {
+        PersistentList<Page> pages(path.c_str());
+        assert(pages.size() == 3);
+        assert(pages.rbegin()->bytes[9'999] == 2);
+    }
+
+    // A file cut short or with links pointing nowhere is refused.
+    auto rejected = [&] {
+        try {
+            PersistentList<Page> pages(path.c_str());
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    auto poke = [&](std::streamoff at, uint64_t value) {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(at);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    constexpr std::streamoff kFreeHead = 32;
+    constexpr std::streamoff kFirst = 40;
+    poke(kFreeHead, 12'345);
+    assert(rejected());
+    poke(kFreeHead, 0);
+    poke(kFirst, uint64_t{1} << 40);
+    assert(rejected());
+    poke(kFirst, 8);
+    assert(rejected());
+    // Links inside the list are walked too, and must add up to sz.
+    constexpr std::streamoff kSize = 16;
+    constexpr std::streamoff kFirstNext = 56;  // next of the node at offset 56
+    poke(kFirst, kFirstNext);
+    assert(!rejected());
+    poke(kSize, 2);
+    assert(rejected());
+    poke(kSize, 4);
+    assert(rejected());
+    poke(kSize, 3);
+    poke(kFirstNext, uint64_t{1} << 40);
+    assert(rejected());
+    std::remove(path.c_str());
+
+    {
+        PersistentList<Page> pages(path.c_str());
+        for (int i = 0; i < 3; ++i) {
+            pages.push_back(Page{});
+        }
+    }
+    assert(truncate(path.c_str(), 20'000) == 0);
+    assert(rejected());
+    std::remove(path.c_str());
+}
+
+template <typename Alloc = std::allocator<int>>
+void TestRanges(Alloc alloc = Alloc()) {
+    using IntList = List<int, Alloc>;
+    static_assert(std::ranges::bidirectional_range<IntList>);
+    static_assert(std::ranges::bidirectional_range<const IntList>);
+    static_assert(std::ranges::common_range<IntList>);
+    static_assert(std::ranges::sized_range<IntList>);
+    static_assert(std::ranges::viewable_range<IntList&>);
+
+    IntList lst(alloc);
+    for (int i = 0; i < 10; ++i) {
+        lst.push_back(i);
+    }
+
+    auto odd_squares =
+        lst | std::views::filter([](int x) { return x % 2 == 1; }) |
+        std::views::transform([](int x) { return x * x; });
+    IntList out = odd_squares | to_list<IntList>(alloc);
+    assert(out.size() == 5);
+    assert(*out.begin() == 1 && *out.rbegin() == 81);
+
+    IntList reversed = to_list<IntList>(alloc)(lst | std::views::reverse);
+    assert(*reversed.begin() == 9);
+
+    // iota is not a common range, so this goes through the sentinel path.
+    auto first_three = std::views::iota(0) | std::views::take(3);
+    IntList counted(first_three.begin(), first_three.end(), alloc);
+    assert(counted.size() == 3);
+
+    const IntList& clst = lst;
+    assert(std::ranges::find(clst, 7) != clst.end());
+    assert(std::ranges::distance(clst) == 10);
+    assert(--clst.end() == --lst.end());
+}
+
+// Runs every kernel this CPU supports against the std algorithms.
+template <typename ListType>
+void CheckBulkAlgorithms(const ListType& lst, std::initializer_list<int> needles) {
+    std::vector<int> plain(lst.begin(), lst.end());
+    int64_t sum = 0;
+    for (int x : plain) {
+        sum += x;
+    }
+    for (auto isa : {list_detail::Isa::kScalar, list_detail::Isa::kSse41,
+                     list_detail::Isa::kAvx2}) {
+        if (isa > list_detail::best_isa()) {
+            continue;
+        }
+        for (int needle : needles) {
+            auto it = list_detail::find(lst, needle, isa);
+            auto expected = std::find(plain.begin(), plain.end(), needle);
+            if (expected == plain.end()) {
+                assert(it == lst.cend());
+            } else {
+                assert(std::distance(lst.cbegin(), it) ==
+                       std::distance(plain.begin(), expected));
+            }
+            assert(list_detail::count(lst, needle, isa) ==
+                   static_cast<size_t>(std::count(plain.begin(), plain.end(), needle)));
+        }
+        assert(list_detail::accumulate(lst, int64_t{0}, isa) == sum);
+        assert(list_detail::accumulate(lst, 0, isa) == static_cast<int>(sum));
+        if (!plain.empty()) {
+            auto [lo, hi] = list_detail::minmax(lst, isa);
+            assert(lo == *std::min_element(plain.begin(), plain.end()));
+            assert(hi == *std::max_element(plain.begin(), plain.end()));
+        }
+    }
+}
+
+template <typename Alloc = std::allocator<int>>
+void TestBulkAlgorithms(Alloc alloc = Alloc()) {
+    List<int, Alloc> lst(alloc);
+    CheckBulkAlgorithms(lst, {0});
+    for (int i = 0; i < 1'000; ++i) {
+        lst.push_back((i * 7919) % 1'000 - 500);
+    }
+    // Break the runs up: a hole in the middle and a node from elsewhere.
+    auto mid = std::next(lst.cbegin(), 500);
+    lst.erase(std::prev(mid));
+    lst.insert(std::next(mid, 100), 12'345);
+    lst.push_front(-777);
+    CheckBulkAlgorithms(lst, {-777, 12'345, 0, 499, -500, 100'000});
+
+    assert(list_find(lst, 12'345) != lst.cend() && *list_find(lst, 12'345) == 12'345);
+    assert(list_count(lst, -777) == 1);
+    assert(list_minmax(lst).second == 12'345);
+
+    List<double, typename std::allocator_traits<Alloc>::template rebind_alloc<double>>
+        doubles(3, 1.5, alloc);
+    assert(list_accumulate(doubles, 0.0) == 4.5);
+    assert(list_count(doubles, 1.5) == 3);
+    List<int, Alloc> empty(alloc);
+    bool thrown = false;
+    try {
+        list_minmax(empty);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// Arena nodes are back to back, so the kernels take the block paths; holes
+// of every length up to a few blocks split the runs at every offset.
+void TestContiguousRuns() {
+    using Alloc = StackAllocator<int, 200'000>;
+    for (int gap = 1; gap <= 20; ++gap) {
+        StackStorage<200'000> storage;
+        List<int, Alloc> lst{Alloc(storage)};
+        for (int i = 0; i < 300; ++i) {
+            lst.push_back(i % 97 - 40);
+        }
+        int position = 0;
+        for (auto it = lst.cbegin(); it != lst.cend(); ++position) {
+            auto next = std::next(it);
+            if (position % gap == gap - 1) {
+                lst.erase(it);
+            }
+            it = next;
+        }
+        CheckBulkAlgorithms(lst, {-40, 0, 56, 57});
+        // Every element is found at its own node, whatever block it is in.
+        for (auto it = lst.cbegin(); it != lst.cend(); ++it) {
+            if (std::find(lst.cbegin(), it, *it) == it) {
+                assert(list_find(lst, *it) == it);
+            }
+        }
+    }
+}
+
+template <size_t N>
+bool InStorage(const void* ptr, const StackStorage<N>& storage) {
+    auto* byte = static_cast<const char*>(ptr);
+    return byte >= storage.arr && byte < storage.arr + N;
+}
+
+void TestMoveSemantics() {
+    using Alloc = StackAllocator<std::string, 200'000>;
+    StackStorage<200'000> first_storage;
+    StackStorage<200'000> second_storage;
+
+    // Same arena: the ring is stolen, no node is allocated.
+    {
+        List<std::string, Alloc> lst{Alloc(first_storage)};
+        List<std::string, Alloc> another{Alloc(first_storage)};
+        another.push_back("a");
+        another.emplace_back(3, 'b');
+        const std::string* first = &*another.begin();
+        size_t shift = first_storage.shift;
+
+        lst = std::move(another);
+        assert(lst.size() == 2 && another.size() == 0);
+        assert(&*lst.begin() == first);
+        assert(*lst.rbegin() == "bbb");
+        assert(first_storage.shift == shift);
+    }
+
+    // Different arenas: elements move into our own nodes, existing nodes are
+    // reused and nothing from the other arena ends up in this list.
+    {
+        List<std::string, Alloc> lst{Alloc(first_storage)};
+        lst.push_back("old1");
+        lst.push_back("old2");
+        const std::string* reused = &*lst.begin();
+
+        List<std::string, Alloc> another{Alloc(second_storage)};
+        for (int i = 0; i < 5; ++i) {
+            another.push_back(std::string(20, static_cast<char>('a' + i)));
+        }
+
+        lst = std::move(another);
+        assert(lst.size() == 5 && another.size() == 0);
+        assert(&*lst.begin() == reused);
+        char expected = 'a';
+        for (const std::string& el : lst) {
+            assert(InStorage(&el, first_storage));
+            assert(el == std::string(20, expected++));
+        }
+
+        // And shrinking drops our surplus nodes.
+        List<std::string, Alloc> shorter{Alloc(second_storage)};
+        shorter.push_back("x");
+        lst = std::move(shorter);
+        assert(lst.size() == 1 && *lst.begin() == "x");
+        assert(InStorage(&*lst.begin(), first_storage));
+    }
+
+    // std::allocator propagates on move assignment.
+    {
+        List<std::string> lst(3, "old");
+        List<std::string> another(2, "new");
+        const std::string* first = &*another.begin();
+        lst = std::move(another);
+        assert(lst.size() == 2 && &*lst.begin() == first);
+    }
+
+    // A moved-to list must be properly relinked in both directions.
+    {
+        List<int> lst;
+        for (int i = 0; i < 4; ++i) {
+            lst.push_back(i);
+        }
+        List<int> moved(std::move(lst));
+        assert(lst.size() == 0 && lst.begin() == lst.end());
+        moved.push_front(-1);
+        moved.push_back(4);
+        assert(*moved.begin() == -1 && *moved.rbegin() == 4);
+        assert(*std::next(moved.rbegin(), 5) == -1);
+        moved.pop_front();
+        moved.pop_back();
+        assert(*moved.begin() == 0 && *moved.rbegin() == 3);
+    }
+}
+
+template <typename Chan, typename Counter>
+Task ChannelProducer(Chan& ch, int from, int to, Counter& pushed) {
+    for (int i = from; i < to; ++i) {
+        if (!co_await ch.push(i)) {
+            co_return;
+        }
+        ++pushed;
+    }
+}
+
+template <typename Chan>
+Task ChannelConsumer(Chan& ch, std::vector<int>& got) {
+    while (std::optional<int> value = co_await ch.pop()) {
+        got.push_back(*value);
+    }
+}
+
+template <typename Chan>
+Task ChannelBatchConsumer(Chan& ch, std::vector<size_t>& batches,
+                          int64_t& sum) {
+    while (true) {
+        auto batch = co_await ch.pop_all();
+        if (batch.size() == 0) {
+            co_return;
+        }
+        batches.push_back(batch.size());
+        for (int el : batch) {
+            sum += el;
+        }
+    }
+}
+
+void TestChannel() {
+    using Alloc = StackAllocator<int, 200'000>;
+    StackStorage<200'000> storage;
+
+    // Back-pressure: the producer stops at capacity until a consumer runs,
+    // order is preserved and nodes are recycled instead of reallocated.
+    {
+        InlineScheduler scheduler;
+        Channel<int, Alloc> ch(scheduler, 4, Alloc(storage));
+        int pushed = 0;
+        std::vector<int> got;
+
+        spawn(scheduler, ChannelProducer(ch, 0, 100, pushed));
+        scheduler.run();
+        assert(pushed == 4 && ch.size() == 4);
+
+        spawn(scheduler, ChannelConsumer(ch, got));
+        scheduler.run();
+        assert(pushed == 100 && got.size() == 100);
+        for (int i = 0; i < 100; ++i) {
+            assert(got[i] == i);
+        }
+
+        size_t shift = storage.shift;
+        spawn(scheduler, ChannelProducer(ch, 100, 200, pushed));
+        scheduler.run();
+        assert(got.size() == 200 && got.back() == 199);
+        assert(storage.shift == shift);
+
+        ch.close();
+        scheduler.run();
+    }
+
+    // pop_all drains the buffer in one batch; close fails pending pushes
+    // and ends consumers only after the buffer is drained.
+    {
+        InlineScheduler scheduler;
+        Channel<int, Alloc> ch(scheduler, 8, Alloc(storage));
+        int pushed = 0;
+        std::vector<size_t> batches;
+        int64_t sum = 0;
+
+        spawn(scheduler, ChannelProducer(ch, 0, 10, pushed));
+        scheduler.run();
+        assert(pushed == 8);
+        spawn(scheduler, ChannelBatchConsumer(ch, batches, sum));
+        scheduler.run();
+        assert(batches[0] == 8);
+        assert(std::accumulate(batches.begin(), batches.end(), size_t{0}) == 10);
+        assert(sum == 45);
+
+        int late = 0;
+        spawn(scheduler, ChannelProducer(ch, 0, 20, late));
+        scheduler.run();
+        ch.close();
+        scheduler.run();
+        assert(late == 20 && sum == 45 + 190);
+
+        spawn(scheduler, ChannelProducer(ch, 0, 1, late));
+        scheduler.run();
+        assert(late == 20);
+    }
+
+    bool threw = false;
+    try {
+        InlineScheduler scheduler;
+        Channel<int> ch(scheduler, 0);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Several producers and consumers on worker threads. The pool is
+    // joined before the channel its coroutines use goes away.
+    {
+        std::vector<int> got[2];
+        std::atomic<int> pushed = 0;
+        auto scheduler = std::make_unique<ThreadPoolScheduler>(4);
+        Channel<int, Alloc> ch(*scheduler, 16, Alloc(storage));
+        spawn(*scheduler, ChannelConsumer(ch, got[0]));
+        spawn(*scheduler, ChannelConsumer(ch, got[1]));
+        for (int i = 0; i < 3; ++i) {
+            spawn(*scheduler,
+                  ChannelProducer(ch, i * 1'000, (i + 1) * 1'000, pushed));
+        }
+        while (pushed < 3'000 || ch.size() != 0) {
+            std::this_thread::yield();
+        }
+        ch.close();
+        scheduler.reset();
+
+        std::vector<int> all = got[0];
+        all.insert(all.end(), got[1].begin(), got[1].end());
+        std::sort(all.begin(), all.end());
+        assert(all.size() == 3'000);
+        for (int i = 0; i < 3'000; ++i) {
+            assert(all[i] == i);
+        }
+    }
+}
+
+template <typename Snapshot>
+std::vector<int> Collect(const Snapshot& snapshot) {
+    return std::vector<int>(snapshot.begin(), snapshot.end());
+}
+
+void TestSnapshotList() {
+    // A snapshot keeps showing the version it was taken at.
+    {
+        SnapshotList<int> lst;
+        for (int i = 0; i < 5; ++i) {
+            lst.push_back(i);
+        }
+        auto before = lst.snapshot();
+        lst.erase(std::next(before.begin(), 2));
+        lst.push_front(-1);
+        lst.insert(before.begin(), -2);
+        assert(!lst.erase(std::next(before.begin(), 2)));
+        auto after = lst.snapshot();
+
+        assert((Collect(before) == std::vector<int>{0, 1, 2, 3, 4}));
+        assert((Collect(after) == std::vector<int>{-1, -2, 0, 1, 3, 4}));
+        assert(lst.size() == 6 && after.version() > before.version());
+    }
+
+    // Erased elements are destroyed only once no snapshot can reach them.
+    Accountant::reset();
+    {
+        SnapshotList<Accountant> lst;
+        Accountant el;
+        for (int i = 0; i < 4; ++i) {
+            lst.push_back(el);
+        }
+        {
+            auto held = lst.snapshot();
+            lst.erase(held.begin());
+            lst.erase(std::next(held.begin()));
+            lst.reclaim();
+            assert(Accountant::dtor_calls == 0);
+            assert(std::distance(held.begin(), held.end()) == 4);
+        }
+        lst.reclaim();
+        assert(Accountant::dtor_calls == 2);
+
+        auto fresh = lst.snapshot();
+        lst.erase(fresh.begin());
+        assert(Accountant::dtor_calls == 2);
+    }
+    assert(Accountant::ctor_calls == Accountant::dtor_calls);
+
+    // Allocation stays under the writer lock, so an arena works too.
+    {
+        StackStorage<100'000> storage;
+        SnapshotList<int, StackAllocator<int, 100'000>> lst{
+            StackAllocator<int, 100'000>(storage)};
+        lst.push_back(1);
+        lst.push_back(2);
+        assert((Collect(lst.snapshot()) == std::vector<int>{1, 2}));
+    }
+
+    // Readers running next to a writer see only complete versions: every
+    // version holds 100 or 101 consecutive integers.
+    {
+        SnapshotList<int> lst;
+        for (int i = 0; i < 100; ++i) {
+            lst.push_back(i);
+        }
+        std::atomic<bool> stop = false;
+        std::atomic<size_t> bad = 0;
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r) {
+            readers.emplace_back([&] {
+                while (!stop) {
+                    auto snapshot = lst.snapshot();
+                    size_t count = 0;
+                    int expected = *snapshot.begin();
+                    for (int el : snapshot) {
+                        count += static_cast<size_t>(el == expected++);
+                    }
+                    if (count != 100 && count != 101) {
+                        ++bad;
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < 20'000; ++i) {
+            auto snapshot = lst.snapshot();
+            int front = *snapshot.begin();
+            lst.push_back(front + 100);
+            lst.erase(snapshot.begin());
+        }
+        stop = true;
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        assert(bad == 0);
+    }
+}
+
+void TestStackAllocatorInPlace() {
+    StackStorage<1'000> storage;
+    StackAllocator<int, 1'000> alloc(storage);
+
+    int* first = alloc.allocate(4);
+    assert(alloc.try_expand(first, 4, 100));
+    assert(storage.shift == 400);
+    assert(alloc.shrink(first, 100, 10));
+    assert(storage.shift == 40);
+
+    // Only the top block can change size.
+    int* second = alloc.allocate(1);
+    assert(!alloc.try_expand(first, 10, 20));
+    assert(!alloc.shrink(first, 10, 5));
+    assert(!alloc.try_expand(second, 1, 1'000));
+    assert(storage.shift == 44);
+
+    // allocate_at_least hands out the padding up to max_align_t.
+    auto result = alloc.allocate_at_least(1);
+    assert(result.ptr == second + 1 && result.count >= 1);
+    assert(storage.shift % alignof(std::max_align_t) == 0);
+
+    bool threw = false;
+    try {
+        alloc.allocate(1'000);
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+template <typename Alloc = std::allocator<std::string>>
+void TestVector(Alloc alloc = Alloc()) {
+    Vector<std::string, Alloc> vec(alloc);
+    for (int i = 0; i < 100; ++i) {
+        vec.push_back(std::to_string(i));
+    }
+    vec.push_back(vec[0]);
+    assert(vec.size() == 101 && vec.capacity() >= 101);
+    assert(vec.back() == "0" && vec[42] == "42");
+
+    Vector<std::string, Alloc> copy = vec;
+    vec.pop_back();
+    assert(copy.size() == 101 && vec.size() == 100);
+    copy = vec;
+    assert(copy.size() == 100 && copy[99] == "99");
+
+    Vector<std::string, Alloc> moved = std::move(copy);
+    assert(moved.size() == 100 && copy.size() == 0);
+    moved.shrink_to_fit();
+    assert(moved.capacity() == 100 && moved[7] == "7");
+    moved.clear();
+    assert(moved.empty());
+
+    bool threw = false;
+    try {
+        vec.at(100);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+void TestVectorGrowsInPlace() {
+    StackStorage<100'000> storage;
+    using Alloc = StackAllocator<int, 100'000>;
+
+    // Append-only growth at the top of the arena never moves or wastes.
+    Vector<int, Alloc> vec{Alloc(storage)};
+    vec.push_back(0);
+    const int* data = vec.data();
+    for (int i = 1; i < 1'000; ++i) {
+        vec.push_back(i);
+    }
+    assert(vec.data() == data);
+    assert(storage.shift <= 1'024 * sizeof(int));
+    vec.shrink_to_fit();
+    assert(storage.shift == 1'000 * sizeof(int));
+
+    // Once something sits above it, growth has to move.
+    Vector<int, Alloc> other{Alloc(storage)};
+    other.push_back(-1);
+    vec.push_back(1'000);
+    assert(vec.data() != data && vec.size() == 1'001);
+    for (int i = 0; i <= 1'000; ++i) {
+        assert(vec[i] == i);
+    }
+}
+
+template <typename Alloc = std::allocator<int>>
+void TestForwardList(Alloc alloc = Alloc()) {
+    using FList = ForwardList<int, Alloc>;
+    FList lst(alloc);
+    for (int i = 0; i < 5; ++i) {
+        lst.push_back(i);
+    }
+    lst.push_front(-1);
+    assert(lst.size() == 6 && lst.back() == 4);
+    assert((std::vector<int>(lst.begin(), lst.end()) ==
+            std::vector<int>{-1, 0, 1, 2, 3, 4}));
+
+    // Erasing and inserting after the last node keep push_back O(1).
+    auto it = std::next(lst.begin(), 4);  // 3
+    lst.erase_after(it);
+    assert(lst.back() == 3);
+    lst.insert_after(it, 10);
+    lst.push_back(11);
+    assert(lst.back() == 11);
+    lst.pop_front();
+    lst.erase_after(lst.before_begin(), std::next(lst.begin()));
+    assert((std::vector<int>(lst.begin(), lst.end()) ==
+            std::vector<int>{1, 2, 3, 10, 11}));
+
+    std::array<int, 3> extra = {7, 8, 9};
+    lst.insert_after(lst.begin(), extra.begin(), extra.end());
+    assert(lst.size() == 8 && *std::next(lst.begin(), 3) == 9);
+
+    FList other(alloc);
+    other.push_back(100);
+    other.push_back(200);
+    lst.splice_after(lst.before_begin(), other, other.before_begin());
+    assert(other.size() == 1 && other.back() == 200 && *lst.begin() == 100);
+    lst.splice_after(std::next(lst.begin(), lst.size() - 1), other);
+    assert(other.size() == 0 && lst.back() == 200 && lst.size() == 10);
+    other.push_back(1);
+    assert(other.size() == 1 && *other.begin() == 1);
+
+    // Sorting relinks the nodes and is stable.
+    std::vector<const int*> addresses;
+    for (const int& el : lst) {
+        addresses.push_back(&el);
+    }
+    lst.sort();
+    assert(std::is_sorted(lst.begin(), lst.end()));
+    assert(lst.back() == 200 && lst.size() == 10);
+    for (const int& el : lst) {
+        assert(std::find(addresses.begin(), addresses.end(), &el) !=
+               addresses.end());
+    }
+    lst.sort(std::greater<>());
+    assert(*lst.begin() == 200 && lst.back() == 1);
+    lst.push_back(0);
+    assert(lst.back() == 0 && lst.size() == 11);
+
+    FList copy = lst;
+    assert(copy.size() == 11 && copy.back() == 0);
+    FList moved = std::move(copy);
+    assert(copy.size() == 0 && moved.size() == 11);
+    copy.push_back(5);
+    moved = copy;
+    assert(moved.size() == 1 && moved.back() == 5);
+    moved.swap(lst);
+    assert(moved.size() == 11 && lst.size() == 1);
+    lst.clear();
+    lst.push_back(3);
+    assert(lst.size() == 1 && lst.back() == 3);
+}
+
+void TestForwardListStability() {
+    ForwardList<std::pair<int, int>> lst;
+    for (int i = 0; i < 1'000; ++i) {
+        lst.emplace_back((i * 7919) % 10, i);
+    }
+    lst.sort([](const auto& a, const auto& b) { return a.first < b.first; });
+    auto prev = *lst.begin();
+    for (const auto& el : lst) {
+        assert(prev.first < el.first ||
+               (prev.first == el.first && prev.second <= el.second));
+        prev = el;
+    }
+    assert(lst.size() == 1'000);
+
+    // A node costs one link less than List's.
+    StackStorage<10'000> storage;
+    using Alloc = StackAllocator<int, 10'000>;
+    ForwardList<int, Alloc> forward{Alloc(storage)};
+    forward.push_back(1);
+    size_t forward_bytes = storage.shift;
+    List<int, Alloc> list{Alloc(storage)};
+    list.push_back(1);
+    assert(storage.shift - forward_bytes > forward_bytes);
+}
+
+// Across arenas ForwardList goes through the same element-wise move as
+// List: our nodes are reused, surplus ones dropped and missing ones added.
+void TestForwardListMoveAcrossArenas() {
+    using Alloc = StackAllocator<int, 10'000>;
+    StackStorage<10'000> first_storage;
+    StackStorage<10'000> second_storage;
+
+    ForwardList<int, Alloc> lst{Alloc(first_storage)};
+    lst.push_back(-1);
+    lst.push_back(-2);
+    const int* reused = &*lst.begin();
+    ForwardList<int, Alloc> longer{Alloc(second_storage)};
+    for (int i = 0; i < 5; ++i) {
+        longer.push_back(i);
+    }
+    lst = std::move(longer);
+    assert(longer.size() == 0 && lst.size() == 5 && lst.back() == 4);
+    assert(&*lst.begin() == reused);
+    assert((std::vector<int>(lst.begin(), lst.end()) == std::vector<int>{0, 1, 2, 3, 4}));
+
+    ForwardList<int, Alloc> shorter{Alloc(second_storage)};
+    shorter.push_back(7);
+    lst = std::move(shorter);
+    assert(lst.size() == 1 && lst.back() == 7 && &*lst.begin() == reused);
+    lst.push_back(8);
+    assert(lst.size() == 2 && lst.back() == 8);
+}
+
+template <typename Alloc = std::allocator<std::pair<int, int>>>
+void TestMergeK(Alloc alloc = Alloc()) {
+    using Item = std::pair<int, int>;  // key, source list
+    auto by_key = [](const Item& a, const Item& b) { return a.first < b.first; };
+
+    for (size_t k : {1, 2, 5, 16}) {
+        std::vector<List<Item, Alloc>> lists;
+        std::vector<const Item*> nodes;
+        for (size_t i = 0; i < k; ++i) {
+            lists.emplace_back(alloc);
+            for (int key = static_cast<int>(i % 3); key < 60;
+                 key += static_cast<int>(i % 4) + 1) {
+                nodes.push_back(&lists.back().emplace_back(key, static_cast<int>(i)));
+            }
+        }
+        lists.emplace_back(alloc);  // an empty list takes part too
+
+        List<Item, Alloc> merged = merge_k(std::span(lists), by_key);
+        assert(merged.size() == nodes.size());
+        for (const List<Item, Alloc>& lst : lists) {
+            assert(lst.size() == 0);
+        }
+        // Sorted, stable across lists, and made of the very same nodes.
+        const Item* prev = nullptr;
+        for (const Item& el : merged) {
+            assert(std::find(nodes.begin(), nodes.end(), &el) != nodes.end());
+            assert(prev == nullptr || prev->first < el.first ||
+                   (prev->first == el.first && prev->second < el.second));
+            prev = &el;
+        }
+    }
+
+    std::vector<List<Item, Alloc>> lists;
+    for (int i = 0; i < 8; ++i) {
+        lists.emplace_back(alloc);
+        for (int key = 0; key < 1'000; key += 1 + i) {
+            lists.back().emplace_back(key, i);
+        }
+    }
+    List<Item, Alloc> expected =
+        merge_k(std::span(lists.data(), lists.size()), by_key);
+    for (const Item& el : expected) {
+        lists[static_cast<size_t>(el.second)].push_back(el);
+    }
+    List<Item, Alloc> parallel = merge_k_parallel(std::span(lists), 3, by_key);
+    assert(std::equal(parallel.begin(), parallel.end(), expected.begin(),
+                      expected.end()));
+
+    if constexpr (std::is_default_constructible_v<Alloc>) {
+        assert(merge_k(std::span<List<Item, Alloc>>()).size() == 0);
+    } else {
+        bool threw = false;
+        try {
+            merge_k(std::span<List<Item, Alloc>>());
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+}
+
+void TestMergeKAcrossArenas() {
+    using Alloc = StackAllocator<int, 100'000>;
+    StackStorage<100'000> first_storage;
+    StackStorage<100'000> second_storage;
+    std::vector<List<int, Alloc>> lists;
+    lists.emplace_back(Alloc(first_storage));
+    lists.emplace_back(Alloc(second_storage));
+    for (int i = 0; i < 10; ++i) {
+        lists[static_cast<size_t>(i % 2)].push_back(i);
+    }
+
+    // Nodes of the second arena are copied into the first one.
+    List<int, Alloc> merged = merge_k(std::span(lists));
+    assert(merged.size() == 10);
+    int expected = 0;
+    for (const int& el : merged) {
+        assert(el == expected++);
+        assert(InStorage(&el, first_storage));
+    }
+}
+
+std::vector<int> Contents(ConcurrentList<int>& lst) {
+    std::vector<int> result;
+    lst.for_each([&](int el) { result.push_back(el); });
+    return result;
+}
+
+void TestConcurrentList() {
+    // Iterators survive the erasure of their own element.
+    {
+        ConcurrentList<int> lst;
+        for (int i = 0; i < 5; ++i) {
+            lst.push_back(i);
+        }
+        lst.push_front(-1);
+        auto two = std::next(lst.begin(), 3);
+        auto three = std::next(two);
+        assert(*two == 2 && *three == 3);
+
+        assert(lst.erase(two) && lst.erase(three));
+        assert(!lst.erase(two) && !two.alive() && *two == 2);
+        assert(*std::next(two) == 4 && *std::next(three) == 4);
+
+        lst.insert(two, 10);  // goes before 4, the next survivor
+        auto inserted = lst.insert(lst.begin(), 20);
+        assert(*inserted == 20 && inserted.alive());
+        assert((Contents(lst) == std::vector<int>{20, -1, 0, 1, 10, 4}));
+        assert(lst.size() == 6);
+        assert(std::distance(lst.begin(), lst.end()) == 6);
+    }
+
+    // An erased element lives as long as some iterator stands on it.
+    Accountant::reset();
+    {
+        ConcurrentList<Accountant> lst;
+        Accountant el;
+        lst.push_back(el);
+        lst.push_back(el);
+        {
+            auto first = lst.begin();
+            auto second = std::next(first);
+            lst.erase(first);
+            lst.erase(second);
+            assert(Accountant::dtor_calls == 0 && lst.empty());
+            first = second;
+            assert(Accountant::dtor_calls == 1);
+        }
+        assert(Accountant::dtor_calls == 2);
+        lst.push_back(el);
+    }
+    assert(Accountant::ctor_calls == Accountant::dtor_calls);
+
+    // Threads inserting and erasing at random positions while others walk
+    // the list: no value is lost or duplicated and size() adds up.
+    {
+        ConcurrentList<int> lst;
+        for (int i = 0; i < 200; ++i) {
+            lst.push_back(-1);
+        }
+        constexpr int kWriters = 4;
+        constexpr int kOps = 3'000;
+        std::atomic<bool> stop = false;
+        std::atomic<size_t> erased = 0;
+        std::atomic<size_t> walked = 0;
+        std::vector<std::thread> threads;
+        for (int w = 0; w < kWriters; ++w) {
+            threads.emplace_back([&, w] {
+                unsigned state = w + 1;
+                for (int i = 0; i < kOps; ++i) {
+                    state = state * 1'103'515'245 + 12'345;
+                    auto it = lst.begin();
+                    for (unsigned step = (state >> 16) % 64;
+                         step > 0 && it != lst.end(); --step) {
+                        ++it;
+                    }
+                    if (i % 3 == 2 && it != lst.end()) {
+                        erased += static_cast<size_t>(lst.erase(it));
+                    } else {
+                        lst.insert(it, w * kOps + i);
+                    }
+                }
+            });
+        }
+        threads.emplace_back([&] {
+            while (!stop) {
+                for (auto it = lst.begin(); it != lst.end(); ++it) {
+                    ++walked;
+                }
+                lst.for_each([&](int) { ++walked; });
+            }
+        });
+        for (int w = 0; w < kWriters; ++w) {
+            threads[w].join();
+        }
+        stop = true;
+        threads.back().join();
+
+        std::vector<int> values = Contents(lst);
+        size_t inserted = 200 + kWriters * (kOps - kOps / 3);
+        assert(values.size() == inserted - erased && lst.size() == values.size());
+        std::erase(values, -1);
+        std::sort(values.begin(), values.end());
+        assert(std::adjacent_find(values.begin(), values.end()) == values.end());
+        assert(walked > 0);
+    }
+}
+
+// Copies of trivially copyable T are chained in one pass; running out of
+// memory halfway must still leave both lists as they were.
+void TestTrivialCopy() {
+    StackStorage<1'000> storage;
+    using Alloc = StackAllocator<int, 1'000>;
+    List<int, Alloc> lst{Alloc(storage)};
+    for (int i = 0; i < 20; ++i) {
+        lst.push_back(i);
+    }
+    List<int, Alloc> copy = lst;
+    assert(std::equal(copy.begin(), copy.end(), lst.begin(), lst.end()));
+    assert(*copy.rbegin() == 19 && *std::prev(copy.end(), 20) == 0);
+
+    bool thrown = false;
+    try {
+        copy = lst;
+    } catch (const std::bad_alloc&) {
+        thrown = true;
+    }
+    assert(thrown && copy.size() == 20 && *copy.rbegin() == 19);
+
+    std::vector<int> values{7, 8, 9};
+    List<int> from_range(values.begin(), values.end());
+    from_range.insert(from_range.cbegin(), values.begin(), values.end());
+    assert((std::vector<int>(from_range.begin(), from_range.end()) ==
+            std::vector<int>{7, 8, 9, 7, 8, 9}));
+    assert(*from_range.rbegin() == 9 && *std::next(from_range.rbegin()) == 8);
+}
+
 struct ThrowingAccountant : public Accountant {
     static bool need_throw;  // NOLINT
 
@@ -287,6 +1467,43 @@ void TestExceptionSafety() {
     }
 }
 
+// A throwing element constructor must leave no element alive and, under
+// ASan, no buffer behind.
+void TestVectorExceptionSafety() {
+    Accountant::reset();
+    ThrowingAccountant::need_throw = true;
+
+    bool thrown = false;
+    try {
+        Vector<ThrowingAccountant> vec(8, ThrowingAccountant(1));
+    } catch (...) {
+        thrown = true;
+        assert(Accountant::ctor_calls == 4);
+        assert(Accountant::dtor_calls == 4);
+    }
+    assert(thrown);
+
+    ThrowingAccountant::need_throw = false;
+    Vector<ThrowingAccountant> vec;
+    for (int i = 0; i < 13; ++i) {
+        vec.push_back(i);
+    }
+
+    Accountant::reset();
+    ThrowingAccountant::need_throw = true;
+
+    thrown = false;
+    try {
+        auto copy = vec;
+    } catch (...) {
+        thrown = true;
+        assert(Accountant::ctor_calls == 4);
+        assert(Accountant::dtor_calls == 4);
+    }
+    assert(thrown);
+    ThrowingAccountant::need_throw = false;
+}
+
 void TestAlignment() {
 
     StackStorage<200'000> storage;
@@ -562,6 +1779,113 @@ int main() {
 
     std::cerr << "Test 2 with StackAllocator passed." << std::endl;
 
+    TestClear<>();
+
+    {
+        StackStorage<200'000> storage;
+        StackAllocator<Accountant, 200'000> alloc(storage);
+
+        TestClear<StackAllocator<Accountant, 200'000>>(alloc);
+    }
+    TestTrivialCopy();
+
+    std::cerr << "Test 2.5 (clear) passed." << std::endl;
+
+    TestConstexpr();
+
+    std::cerr << "Test 2.6 (constexpr) passed." << std::endl;
+
+    TestSerialization<>();
+
+    {
+        StackStorage<2'000'000> storage;
+        StackAllocator<int, 2'000'000> alloc(storage);
+
+        TestSerialization<StackAllocator<int, 2'000'000>>(alloc);
+    }
+
+    std::cerr << "Test 2.7 (serialization) passed." << std::endl;
+
+    TestPersistentList();
+
+    std::cerr << "Test 2.8 (persistent list) passed." << std::endl;
+
+    TestRanges<>();
+
+    {
+        StackStorage<200'000> storage;
+        StackAllocator<int, 200'000> alloc(storage);
+
+        TestRanges<StackAllocator<int, 200'000>>(alloc);
+    }
+
+    std::cerr << "Test 2.9 (ranges) passed." << std::endl;
+
+    TestBulkAlgorithms<>();
+
+    {
+        StackStorage<200'000> storage;
+        StackAllocator<int, 200'000> alloc(storage);
+
+        TestBulkAlgorithms<StackAllocator<int, 200'000>>(alloc);
+    }
+
+    TestContiguousRuns();
+
+    std::cerr << "Test 2.10 (bulk algorithms) passed." << std::endl;
+
+    TestMoveSemantics();
+
+    std::cerr << "Test 2.11 (move semantics) passed." << std::endl;
+
+    TestChannel();
+
+    std::cerr << "Test 2.12 (channel) passed." << std::endl;
+
+    TestSnapshotList();
+
+    std::cerr << "Test 2.13 (snapshot list) passed." << std::endl;
+
+    TestStackAllocatorInPlace();
+    TestVector<>();
+    {
+        StackStorage<200'000> storage;
+        StackAllocator<std::string, 200'000> alloc(storage);
+
+        TestVector<StackAllocator<std::string, 200'000>>(alloc);
+    }
+    TestVectorGrowsInPlace();
+    TestVectorExceptionSafety();
+
+    std::cerr << "Test 2.14 (in-place growth, Vector) passed." << std::endl;
+
+    TestForwardList<>();
+    {
+        StackStorage<200'000> storage;
+        StackAllocator<int, 200'000> alloc(storage);
+
+        TestForwardList<StackAllocator<int, 200'000>>(alloc);
+    }
+    TestForwardListStability();
+    TestForwardListMoveAcrossArenas();
+
+    std::cerr << "Test 2.15 (forward list) passed." << std::endl;
+
+    TestMergeK<>();
+    {
+        StackStorage<200'000> storage;
+        StackAllocator<std::pair<int, int>, 200'000> alloc(storage);
+
+        TestMergeK<StackAllocator<std::pair<int, int>, 200'000>>(alloc);
+    }
+    TestMergeKAcrossArenas();
+
+    std::cerr << "Test 2.16 (k-way merge) passed." << std::endl;
+
+    TestConcurrentList();
+
+    std::cerr << "Test 2.17 (concurrent list) passed." << std::endl;
+
     TestExceptionSafety();
 
     std::cerr << "Test 3 (ExceptionSafety) passed." << std::endl;
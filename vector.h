@@ -0,0 +1,352 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Contiguous growable array whose growth cooperates with bump allocators.
+// When the allocator offers try_expand, as StackAllocator does, a full
+// buffer that sits at the top of the arena is simply extended: nothing is
+// moved and nothing is left behind. Only when that fails, e.g. because
+// something else was allocated after the buffer, does growth fall back to
+// allocate, move and deallocate.
+template <typename T, typename Alloc = std::allocator<T>>
+class Vector {
+  private:
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static constexpr bool kCanExpand =
+        requires(Alloc& alloc, T* ptr, size_t n) {
+            { alloc.try_expand(ptr, n, n) } -> std::same_as<bool>;
+        };
+    static constexpr bool kCanShrink =
+        requires(Alloc& alloc, T* ptr, size_t n) {
+            { alloc.shrink(ptr, n, n) } -> std::same_as<bool>;
+        };
+    static constexpr bool kAllocatesAtLeast =
+        requires(Alloc& alloc, size_t n) { alloc.allocate_at_least(n); };
+
+    [[no_unique_address]] Alloc allocator;
+    T* first = nullptr;
+    size_t sz = 0;
+    size_t cap = 0;
+
+    constexpr std::pair<T*, size_t> allocate(size_t n) {
+        if constexpr (kAllocatesAtLeast) {
+            auto result = allocator.allocate_at_least(n);
+            return {result.ptr, result.count};
+        } else {
+            return {AllocTraits::allocate(allocator, n), n};
+        }
+    }
+
+    constexpr bool try_expand(size_t new_cap) {
+        if constexpr (kCanExpand) {
+            if (first != nullptr && allocator.try_expand(first, cap, new_cap)) {
+                cap = new_cap;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr void destroy_range(T* from, T* to) {
+        for (; from != to; ++from) {
+            AllocTraits::destroy(allocator, from);
+        }
+    }
+
+    // Moves the elements into [to, to + n), which has room for them, and
+    // frees the old buffer. If a move throws, to holds nothing and the
+    // vector is unchanged.
+    constexpr void relocate(T* to, size_t n) {
+        size_t done = 0;
+        try {
+            for (; done < sz; ++done) {
+                AllocTraits::construct(allocator, to + done,
+                                       std::move_if_noexcept(first[done]));
+            }
+        } catch (...) {
+            destroy_range(to, to + done);
+            throw;
+        }
+        release();
+        first = to;
+        cap = n;
+    }
+
+    constexpr void release() {
+        destroy_range(first, first + sz);
+        if (first != nullptr) {
+            AllocTraits::deallocate(allocator, first, cap);
+        }
+    }
+
+    constexpr size_t grown_capacity() const {
+        return cap == 0 ? 1 : 2 * cap;
+    }
+
+  public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    constexpr Vector() = default;
+
+    constexpr Vector(const Alloc& external_allocator)
+        : allocator(external_allocator) {}
+
+    constexpr Vector(size_t n, const T& el,
+                     const Alloc& external_allocator = Alloc())
+        : allocator(external_allocator) {
+        try {
+            reserve(n);
+            while (sz < n) {
+                push_back(el);
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    constexpr Vector(const Vector& another)
+        : allocator(AllocTraits::select_on_container_copy_construction(
+              another.allocator)) {
+        try {
+            reserve(another.sz);
+            for (const T& el : another) {
+                push_back(el);
+            }
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    constexpr Vector(Vector&& another) noexcept
+        : allocator(another.allocator),
+          first(std::exchange(another.first, nullptr)),
+          sz(std::exchange(another.sz, 0)),
+          cap(std::exchange(another.cap, 0)) {}
+
+    constexpr ~Vector() {
+        release();
+    }
+
+    constexpr Vector& operator=(const Vector& another) {
+        Vector copy(allocator);
+        copy.reserve(another.sz);
+        for (const T& el : another) {
+            copy.push_back(el);
+        }
+        swap(copy);
+        if (AllocTraits::propagate_on_container_copy_assignment::value) {
+            allocator = another.allocator;
+        }
+        return *this;
+    }
+
+    // Takes the buffer of another when our allocator can free it, and moves
+    // the elements one by one otherwise.
+    constexpr Vector& operator=(Vector&& another) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value ||
+        AllocTraits::is_always_equal::value) {
+        if (this == &another) {
+            return *this;
+        }
+        bool steal = AllocTraits::propagate_on_container_move_assignment::value ||
+                     AllocTraits::is_always_equal::value ||
+                     allocator == another.allocator;
+        if (steal) {
+            release();
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                allocator = another.allocator;
+            }
+            first = std::exchange(another.first, nullptr);
+            sz = std::exchange(another.sz, 0);
+            cap = std::exchange(another.cap, 0);
+        } else {
+            clear();
+            reserve(another.sz);
+            for (T& el : another) {
+                push_back(std::move(el));
+            }
+            another.clear();
+        }
+        return *this;
+    }
+
+    constexpr void swap(Vector& another) {
+        std::swap(first, another.first);
+        std::swap(sz, another.sz);
+        std::swap(cap, another.cap);
+        if (AllocTraits::propagate_on_container_swap::value) {
+            std::swap(allocator, another.allocator);
+        }
+    }
+
+    constexpr Alloc get_allocator() const {
+        return allocator;
+    }
+
+    constexpr size_t size() const {
+        return sz;
+    }
+
+    constexpr size_t capacity() const {
+        return cap;
+    }
+
+    constexpr bool empty() const {
+        return sz == 0;
+    }
+
+    constexpr T* data() {
+        return first;
+    }
+    constexpr const T* data() const {
+        return first;
+    }
+
+    constexpr T& operator[](size_t i) {
+        return first[i];
+    }
+    constexpr const T& operator[](size_t i) const {
+        return first[i];
+    }
+
+    constexpr T& at(size_t i) {
+        if (i >= sz) {
+            throw std::out_of_range("Vector::at");
+        }
+        return first[i];
+    }
+    constexpr const T& at(size_t i) const {
+        if (i >= sz) {
+            throw std::out_of_range("Vector::at");
+        }
+        return first[i];
+    }
+
+    constexpr T& front() {
+        return first[0];
+    }
+    constexpr const T& front() const {
+        return first[0];
+    }
+
+    constexpr T& back() {
+        return first[sz - 1];
+    }
+    constexpr const T& back() const {
+        return first[sz - 1];
+    }
+
+    constexpr iterator begin() {
+        return first;
+    }
+    constexpr const_iterator begin() const {
+        return first;
+    }
+    constexpr const_iterator cbegin() const {
+        return first;
+    }
+
+    constexpr iterator end() {
+        return first + sz;
+    }
+    constexpr const_iterator end() const {
+        return first + sz;
+    }
+    constexpr const_iterator cend() const {
+        return first + sz;
+    }
+
+    constexpr void reserve(size_t n) {
+        if (n <= cap || try_expand(n)) {
+            return;
+        }
+        auto [to, got] = allocate(n);
+        try {
+            relocate(to, got);
+        } catch (...) {
+            AllocTraits::deallocate(allocator, to, got);
+            throw;
+        }
+    }
+
+    // Returns the unused tail to the allocator: in place when it can shrink
+    // the buffer, by moving into an exact-size buffer otherwise.
+    constexpr void shrink_to_fit() {
+        if (sz == cap) {
+            return;
+        }
+        if constexpr (kCanShrink) {
+            if (allocator.shrink(first, cap, sz)) {
+                cap = sz;
+                return;
+            }
+        }
+        if (sz == 0) {
+            release();
+            first = nullptr;
+            cap = 0;
+            return;
+        }
+        T* to = AllocTraits::allocate(allocator, sz);
+        try {
+            relocate(to, sz);
+        } catch (...) {
+            AllocTraits::deallocate(allocator, to, sz);
+            throw;
+        }
+    }
+
+    template <typename... Args>
+    constexpr T& emplace_back(Args&&... args) {
+        if (sz < cap || try_expand(grown_capacity())) {
+            AllocTraits::construct(allocator, first + sz,
+                                   std::forward<Args>(args)...);
+            return first[sz++];
+        }
+        // args may refer to an element, so the new element is built in the
+        // new buffer before the old ones move out.
+        auto [to, got] = allocate(grown_capacity());
+        try {
+            AllocTraits::construct(allocator, to + sz,
+                                   std::forward<Args>(args)...);
+        } catch (...) {
+            AllocTraits::deallocate(allocator, to, got);
+            throw;
+        }
+        try {
+            relocate(to, got);
+        } catch (...) {
+            AllocTraits::destroy(allocator, to + sz);
+            AllocTraits::deallocate(allocator, to, got);
+            throw;
+        }
+        return first[sz++];
+    }
+
+    constexpr void push_back(const T& el) {
+        emplace_back(el);
+    }
+
+    constexpr void push_back(T&& el) {
+        emplace_back(std::move(el));
+    }
+
+    constexpr void pop_back() {
+        AllocTraits::destroy(allocator, first + --sz);
+    }
+
+    constexpr void clear() {
+        destroy_range(first, first + sz);
+        sz = 0;
+    }
+};